@@ -0,0 +1,327 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "kleverconfig.h"
+#include "logic/editor/editorHandler.hpp"
+#include "logic/editor/editorHighlighter.hpp"
+#include "logic/parser/htmlEscape.h"
+#include "logic/parser/parser.h"
+#include "logic/parser/plugins/syntaxHighlight/kSyntaxHtmlHighlighter.h"
+#include "logic/parser/renderer.h"
+
+// Qt include
+#include <QObject>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QQuickTextDocument>
+#include <QStandardPaths>
+#include <QTextDocument>
+#include <QtTest/QTest>
+
+// C++ include
+#include <memory>
+
+#include <md4qt/src/doc.h>
+
+/**
+ * @class EditorBenchmark
+ * @brief Benchmark of the editor pipeline: parsing, editor highlighting and HTML rendering, measured separately.
+ * The HTML escaping of the code blocks is measured on its own, on multi-megabyte blocks.
+ *
+ * Run with `-o results.xml,xml` or `-o results.csv,csv` to get machine-readable results.
+ */
+class EditorBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    static void initMain();
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void parse_data();
+    void parse();
+    void highlight_data();
+    void highlight();
+    void render_data();
+    void render();
+    void escape_data();
+    void escape();
+    void unescape_data();
+    void unescape();
+    void codeHighlight();
+
+private:
+    void addNoteSizes();
+    void addCodeSizes();
+    QString makeNote(const int lineCount) const;
+    QString makeCode(const int sizeMiB) const;
+    QSharedPointer<MD::Document> parseNote(const QString &md) const;
+
+    const QString dummyPath = QStringLiteral("/home/dummy/");
+    const QString dummyName = QStringLiteral("note.md");
+};
+
+/* Settings Data */
+void EditorBenchmark::initMain()
+{
+    // The highlighting needs a text document, not a window
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    // Keep the user config untouched
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void EditorBenchmark::initTestCase()
+{
+    KleverConfig::setQuickEmojiEnabled(true);
+    KleverConfig::setNoteMapEnabled(true);
+    KleverConfig::setEditorHighlightEnabled(true);
+}
+
+/* Helpers */
+void EditorBenchmark::addNoteSizes()
+{
+    QTest::addColumn<int>("lineCount");
+
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+}
+
+void EditorBenchmark::addCodeSizes()
+{
+    QTest::addColumn<int>("sizeMiB");
+
+    QTest::newRow("1MiB") << 1;
+    QTest::newRow("8MiB") << 8;
+}
+
+QString EditorBenchmark::makeCode(const int sizeMiB) const
+{
+    // C++ with its share of characters to escape
+    static const QString snippet = QStringLiteral(
+        "template<typename T>\n"
+        "bool isSmaller(const T &a, const T &b)\n"
+        "{\n"
+        "    return a < b && !(b < a) ? true : false; // \"strict\" 'order' & co\n"
+        "}\n");
+
+    QString code;
+    code.reserve(sizeMiB * 1024 * 1024 / 2 + snippet.size());
+    while (code.size() * 2 < sizeMiB * 1024 * 1024) {
+        code += snippet;
+    }
+    return code;
+}
+
+QString EditorBenchmark::makeNote(const int lineCount) const
+{
+    // 25 lines, a mix of the syntaxes found in a note
+    static const QString section = QStringLiteral(
+        "## Section %1\n"
+        "\n"
+        "Some **bold** and *italic* text with ==highlight==, ^superscript^ and --subscript-- :smile:\n"
+        "A [[/notes/other:Header %1|wikilink]], a [link](https://kde.org) and some `inline code`.\n"
+        "\n"
+        "- First item\n"
+        "- Second item with ~~strikethrough~~\n"
+        "  - Nested item :thumbs up: dark skin tone:\n"
+        "\n"
+        "1. Ordered\n"
+        "2. List\n"
+        "\n"
+        "```cpp\n"
+        "int main()\n"
+        "{\n"
+        "    return %1;\n"
+        "}\n"
+        "```\n"
+        "\n"
+        "> A quote with $x^2$ math\n"
+        "\n"
+        "| Column | Other |\n"
+        "|--------|-------|\n"
+        "| Cell   | %1    |\n"
+        "\n");
+
+    QString md;
+    for (int line = 0, i = 0; line < lineCount; line += 25, ++i) {
+        md += section.arg(i);
+    }
+    return md;
+}
+
+QSharedPointer<MD::Document> EditorBenchmark::parseNote(const QString &md) const
+{
+    MdEditor::Parser parser;
+    // Apply the plugins, they are set through queued connections
+    QCoreApplication::processEvents();
+
+    QSharedPointer<MD::Document> doc;
+    connect(&parser, &MdEditor::Parser::done, &parser, [&doc](QSharedPointer<MD::Document> mdDoc) {
+        doc = mdDoc;
+    });
+    parser.onData(MdEditor::TextSnapshot::fromText(md), dummyPath, dummyName, MdEditor::TextEdit::fullEdit(), 1);
+    QMetaObject::invokeMethod(&parser, "onParse", Qt::DirectConnection);
+
+    return doc;
+}
+
+/* BENCHMARK */
+void EditorBenchmark::parse_data()
+{
+    addNoteSizes();
+}
+
+void EditorBenchmark::parse()
+{
+    QFETCH(int, lineCount);
+    const auto snapshot = MdEditor::TextSnapshot::fromText(makeNote(lineCount));
+
+    MdEditor::Parser parser;
+    QCoreApplication::processEvents();
+
+    QSharedPointer<MD::Document> doc;
+    connect(&parser, &MdEditor::Parser::done, &parser, [&doc](QSharedPointer<MD::Document> mdDoc) {
+        doc = mdDoc;
+    });
+
+    // Each round is a full parsing, the queued `newData` finds nothing left to parse
+    QBENCHMARK {
+        parser.onData(snapshot, dummyPath, dummyName, MdEditor::TextEdit::fullEdit(), 1);
+        QMetaObject::invokeMethod(&parser, "onParse", Qt::DirectConnection);
+    }
+
+    QVERIFY(doc);
+}
+
+void EditorBenchmark::highlight_data()
+{
+    QTest::addColumn<int>("lineCount");
+    // Whether the formats are already applied, only their differences are then, as when typing
+    QTest::addColumn<bool>("applied");
+
+    QTest::newRow("1k") << 1000 << false;
+    QTest::newRow("1k-applied") << 1000 << true;
+    QTest::newRow("10k") << 10000 << false;
+    QTest::newRow("10k-applied") << 10000 << true;
+    QTest::newRow("100k") << 100000 << false;
+    QTest::newRow("100k-applied") << 100000 << true;
+}
+
+void EditorBenchmark::highlight()
+{
+    QFETCH(int, lineCount);
+    QFETCH(bool, applied);
+    const QString md = makeNote(lineCount);
+    const auto doc = parseNote(md);
+    QVERIFY(doc);
+
+    QQmlEngine engine;
+    QQmlComponent component(&engine);
+    component.setData("import QtQuick\nTextEdit {}", QUrl());
+    std::unique_ptr<QObject> textEdit(component.create());
+    QVERIFY(textEdit);
+    const auto quickDocument = textEdit->property("textDocument").value<QQuickTextDocument *>();
+    QVERIFY(quickDocument);
+
+    MdEditor::EditorHandler handler;
+    handler.setDocument(quickDocument);
+    // The benchmark drives the highlighter itself, the edits are not parsed
+    quickDocument->textDocument()->disconnect(&handler);
+    quickDocument->textDocument()->setPlainText(md);
+
+    auto highlighter = handler.editorHighlighter();
+    highlighter->cacheAndHighlight(doc, true);
+    QBENCHMARK {
+        if (!applied) {
+            highlighter->clearHighlighting();
+        }
+        highlighter->cacheAndHighlight(doc, true);
+    }
+}
+
+void EditorBenchmark::render_data()
+{
+    addNoteSizes();
+}
+
+void EditorBenchmark::render()
+{
+    QFETCH(int, lineCount);
+    const auto doc = parseNote(makeNote(lineCount));
+    QVERIFY(doc);
+
+    Renderer renderer;
+    renderer.setNoteDir(dummyPath);
+    renderer.addExtendedSyntax(8, QStringLiteral("<mark>"), QStringLiteral("</mark>"));
+    renderer.addExtendedSyntax(16, QStringLiteral("<sub>"), QStringLiteral("</sub>"));
+    renderer.addExtendedSyntax(32, QStringLiteral("<sup>"), QStringLiteral("</sup>"));
+
+    QStringList blocks;
+    QBENCHMARK {
+        blocks = renderer.toHtmlBlocks(doc, QStringLiteral("&nbsp;&hookleftarrow;&nbsp;"));
+    }
+
+    QVERIFY(!blocks.isEmpty());
+}
+
+void EditorBenchmark::escape_data()
+{
+    addCodeSizes();
+}
+
+void EditorBenchmark::escape()
+{
+    QFETCH(int, sizeMiB);
+    const QString code = makeCode(sizeMiB);
+
+    QString html;
+    QBENCHMARK {
+        html = htmlEscape::escape(code);
+    }
+
+    QVERIFY(code.size() < html.size());
+}
+
+void EditorBenchmark::unescape_data()
+{
+    addCodeSizes();
+}
+
+void EditorBenchmark::unescape()
+{
+    QFETCH(int, sizeMiB);
+    const QString html = htmlEscape::escape(makeCode(sizeMiB));
+
+    QString code;
+    QBENCHMARK {
+        code = htmlEscape::unescape(html);
+    }
+
+    QVERIFY(code.size() < html.size());
+}
+
+void EditorBenchmark::codeHighlight()
+{
+    // A note with 50 blocks of code, as highlighted by the built-in highlighter
+    const QString code = makeCode(1).left(1000);
+    KSyntaxHtmlHighlighter highlighter;
+
+    QString html;
+    QBENCHMARK {
+        for (int i = 0; i < 50; ++i) {
+            html = highlighter.highlight(code, QStringLiteral("cpp"), QStringLiteral("Breeze Dark"));
+        }
+    }
+
+    QVERIFY(html.contains(QStringLiteral("<span style=")));
+}
+
+QTEST_MAIN(EditorBenchmark)
+#include "editorBenchmark.moc"
@@ -0,0 +1,134 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "logic/parser/chunkedParser.h"
+#include "logic/parser/incrementalParser.h"
+#include "logic/parser/plugins/emoji/emojiPlugin.hpp"
+#include "logic/parser/plugins_helper.h"
+
+// Qt include
+#include <QObject>
+#include <QTextStream>
+#include <QtTest/QTest>
+
+#include <md4qt/src/doc.h>
+#include <md4qt/src/parser.h>
+
+class ChunkedParsingTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void chunkStarts();
+    void fenceNotCut();
+    void listNotCut();
+    void largeNote();
+    void footnoteFallback();
+
+private:
+    QSharedPointer<MD::Document> parse(QString md);
+    QSharedPointer<MD::Document> chunkedParse(const QString &md);
+    QString largeNote(const QString &section);
+
+    // md4qt
+    MD::Parser m_md4qtParser;
+    const QString dummyPath = QStringLiteral("/home/dummy/");
+    const QString dummyName = QStringLiteral("note.md");
+};
+
+/* Settings Data */
+void ChunkedParsingTest::initTestCase()
+{
+    auto inlineParsers = setInlineParsers<EmojiPlugin::EmojiParser>();
+    m_md4qtParser.setInlineParsers(inlineParsers);
+}
+
+/* Helpers */
+QSharedPointer<MD::Document> ChunkedParsingTest::parse(QString md)
+{
+    QTextStream s(&md, QIODeviceBase::ReadOnly);
+    return m_md4qtParser.parse(s, dummyPath, dummyName);
+}
+
+QSharedPointer<MD::Document> ChunkedParsingTest::chunkedParse(const QString &md)
+{
+    const auto generation = QSharedPointer<parseCancellation::Generation>::create(1);
+    return chunkedParser::parse(
+        MdEditor::TextSnapshot::fromText(md),
+        []() {
+            return setInlineParsers<EmojiPlugin::EmojiParser>();
+        },
+        generation,
+        1,
+        dummyPath,
+        dummyName);
+}
+
+QString ChunkedParsingTest::largeNote(const QString &section)
+{
+    QString md;
+    for (int i = 0; i < 1000; ++i) {
+        md += section.arg(i);
+    }
+    return md;
+}
+
+/* TEST */
+void ChunkedParsingTest::chunkStarts()
+{
+    const QString md = QStringLiteral("A\n\nB\n\nC\n\nD\n\nE\n\nF");
+
+    const auto starts = chunkedParser::chunkStarts(MdEditor::TextSnapshot::fromText(md), 3);
+    QCOMPARE_EQ(starts.size(), 3);
+    QCOMPARE_EQ(starts.at(0), 0);
+    QCOMPARE_EQ(starts.at(1), 4);
+    QCOMPARE_EQ(starts.at(2), 8);
+}
+
+void ChunkedParsingTest::fenceNotCut()
+{
+    const QString md = QStringLiteral("A\n\n```\ncode\n\nB\n\nC\n```\n\nD\n\nE");
+
+    const auto starts = chunkedParser::chunkStarts(MdEditor::TextSnapshot::fromText(md), 6);
+    for (const auto start : starts) {
+        QVERIFY(start <= 2 || 8 < start);
+    }
+}
+
+void ChunkedParsingTest::listNotCut()
+{
+    const QString md = QStringLiteral("- A\n\n- B\n\n  C\n\nD\n\n1. E\n\n2. F");
+
+    const auto starts = chunkedParser::chunkStarts(MdEditor::TextSnapshot::fromText(md), 6);
+    QCOMPARE_EQ(starts.size(), 2);
+    QCOMPARE_EQ(starts.at(1), 6);
+}
+
+void ChunkedParsingTest::largeNote()
+{
+    const QString md = largeNote(QStringLiteral("## Section %1\n\nSome *text* :smile:\n\n- item\n- item\n\n```cpp\nint a;\n\nint b;\n```\n\n"));
+
+    const auto doc = chunkedParse(md);
+    if (!doc) {
+        QFAIL("largeNote: A large note should be parsed by chunks");
+    }
+    QVERIFY(incrementalParser::sameDocument(doc, parse(md)));
+    QCOMPARE_EQ(doc->labeledHeadings().size(), parse(md)->labeledHeadings().size());
+}
+
+void ChunkedParsingTest::footnoteFallback()
+{
+    const QString md = largeNote(QStringLiteral("## Section %1\n\nSome text[^1]\n\nMore text\n\n")) + QStringLiteral("[^1]: The footnote");
+
+    const auto doc = chunkedParse(md);
+    if (doc) {
+        QFAIL("footnoteFallback: Footnotes must trigger a full parsing");
+    }
+}
+
+QTEST_MAIN(ChunkedParsingTest)
+#include "chunkedParsingTest.moc"
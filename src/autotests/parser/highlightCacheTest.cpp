@@ -0,0 +1,95 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "logic/parser/plugins/syntaxHighlight/highlightCache.h"
+
+// Qt include
+#include <QDateTime>
+#include <QDirIterator>
+#include <QFile>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+class HighlightCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void roundTrip();
+    void keyFields();
+    void leastRecentlyUsedEvicted();
+
+private:
+    const QString code = QStringLiteral("int main() { return 0; }");
+    const QString html = QStringLiteral("<span style=\"color:#ff0000\">int</span> main() { return 0; } é");
+};
+
+/* TEST */
+void HighlightCacheTest::roundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QByteArray key = HighlightCache::key(code, QStringLiteral("cpp"), QStringLiteral("chroma"), QStringLiteral("nord"), QStringLiteral("1"));
+    {
+        HighlightCache cache(dir.path(), 1024 * 1024);
+        QVERIFY(cache.find(key).isNull());
+        cache.insert(key, html);
+        QCOMPARE(cache.find(key), html);
+    }
+
+    // Kept for the next session
+    HighlightCache cache(dir.path(), 1024 * 1024);
+    QCOMPARE(cache.find(key), html);
+}
+
+void HighlightCacheTest::keyFields()
+{
+    const QByteArray key = HighlightCache::key(code, QStringLiteral("cpp"), QStringLiteral("chroma"), QStringLiteral("nord"), QStringLiteral("1"));
+
+    QCOMPARE(key, HighlightCache::key(code, QStringLiteral("cpp"), QStringLiteral("chroma"), QStringLiteral("nord"), QStringLiteral("1")));
+    QVERIFY(key != HighlightCache::key(code, QStringLiteral("c"), QStringLiteral("chroma"), QStringLiteral("nord"), QStringLiteral("1")));
+    QVERIFY(key != HighlightCache::key(code, QStringLiteral("cpp"), QStringLiteral("pygmentize"), QStringLiteral("nord"), QStringLiteral("1")));
+    QVERIFY(key != HighlightCache::key(code, QStringLiteral("cpp"), QStringLiteral("chroma"), QStringLiteral("monokai"), QStringLiteral("1")));
+    QVERIFY(key != HighlightCache::key(code, QStringLiteral("cpp"), QStringLiteral("chroma"), QStringLiteral("nord"), QStringLiteral("2")));
+    // The fields can't be shifted into each other
+    QVERIFY(HighlightCache::key(QStringLiteral("a"), QStringLiteral("bc"), QString(), QString(), QString())
+            != HighlightCache::key(QStringLiteral("ab"), QStringLiteral("c"), QString(), QString(), QString()));
+}
+
+void HighlightCacheTest::leastRecentlyUsedEvicted()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const qint64 entrySize = html.toUtf8().size();
+    // Room for 3 entries
+    HighlightCache cache(dir.path(), entrySize * 3);
+
+    QList<QByteArray> keys;
+    for (int i = 0; i < 3; ++i) {
+        keys.append(HighlightCache::key(code + QString::number(i), QStringLiteral("cpp"), QStringLiteral("chroma"), QStringLiteral("nord"), QStringLiteral("1")));
+        cache.insert(keys.constLast(), html);
+    }
+
+    // The modification time tells the last use, make the first entry the oldest one and the second the most recent one
+    QDirIterator it(dir.path(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFile file(it.next());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        file.setFileTime(QDateTime::currentDateTime().addSecs(file.fileName().contains(QLatin1String(keys.at(0))) ? -60 : -30),
+                         QFileDevice::FileModificationTime);
+    }
+    QVERIFY(!cache.find(keys.at(1)).isNull());
+
+    cache.insert(HighlightCache::key(code, QStringLiteral("cpp"), QStringLiteral("chroma"), QStringLiteral("nord"), QStringLiteral("1")), html);
+
+    QVERIFY(cache.find(keys.at(0)).isNull());
+    QVERIFY(!cache.find(keys.at(1)).isNull());
+}
+
+QTEST_MAIN(HighlightCacheTest)
+#include "highlightCacheTest.moc"
@@ -0,0 +1,70 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "logic/parser/htmlEscape.h"
+
+// Qt include
+#include <QObject>
+#include <QtTest/QTest>
+
+class HtmlEscapeTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void escape_data();
+    void escape();
+    void unescape_data();
+    void unescape();
+};
+
+/* TEST */
+void HtmlEscapeTest::escape_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<bool>("encode");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("clean") << QStringLiteral("int main() { return 0; }") << true << QStringLiteral("int main() { return 0; }");
+    QTest::newRow("special") << QStringLiteral("a < b && c > \"d\" || 'e'") << true
+                             << QStringLiteral("a &lt; b &amp;&amp; c &gt; &quot;d&quot; || &#39;e&#39;");
+    QTest::newRow("encoded entity") << QStringLiteral("&amp; &#39;") << true << QStringLiteral("&amp;amp; &amp;#39;");
+    QTest::newRow("kept entity") << QStringLiteral("&amp; &#39; & &x &;") << false << QStringLiteral("&amp; &#39; &amp; &amp;x &amp;;");
+    QTest::newRow("non ascii") << QStringLiteral("<é>") << true << QStringLiteral("&lt;é&gt;");
+}
+
+void HtmlEscapeTest::escape()
+{
+    QFETCH(QString, text);
+    QFETCH(bool, encode);
+    QFETCH(QString, expected);
+
+    QCOMPARE(htmlEscape::escape(text, encode), expected);
+}
+
+void HtmlEscapeTest::unescape_data()
+{
+    QTest::addColumn<QString>("html");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("clean") << QStringLiteral("no reference") << QStringLiteral("no reference");
+    QTest::newRow("named") << QStringLiteral("&lt;a&gt; &amp;&colon;") << QStringLiteral("<a> &:");
+    QTest::newRow("legacy") << QStringLiteral("&amp &copy 2") << QStringLiteral("& © 2");
+    QTest::newRow("numeric") << QStringLiteral("&#39;&#x41;&#X1F600;&#65") << QStringLiteral("'A😀A");
+    QTest::newRow("invalid") << QStringLiteral("&#0;&#xD800;&#99999999;") << QStringLiteral("\uFFFD\uFFFD\uFFFD");
+    QTest::newRow("unknown") << QStringLiteral("&unknown; & &# &#x;") << QStringLiteral("&unknown; & &# &#x;");
+    QTest::newRow("roundtrip") << htmlEscape::escape(QStringLiteral("a < b && \"c\" 'd'")) << QStringLiteral("a < b && \"c\" 'd'");
+}
+
+void HtmlEscapeTest::unescape()
+{
+    QFETCH(QString, html);
+    QFETCH(QString, expected);
+
+    QCOMPARE(htmlEscape::unescape(html), expected);
+}
+
+QTEST_MAIN(HtmlEscapeTest)
+#include "htmlEscapeTest.moc"
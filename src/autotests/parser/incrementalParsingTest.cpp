@@ -0,0 +1,262 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "logic/parser/incrementalParser.h"
+#include "logic/parser/plugins/emoji/emojiPlugin.hpp"
+#include "logic/parser/plugins_helper.h"
+
+// Qt include
+#include <QObject>
+#include <QTextStream>
+#include <QtTest/QTest>
+
+#include <md4qt/src/doc.h>
+#include <md4qt/src/parser.h>
+
+class IncrementalParsingTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void textSnapshot();
+    void mergeEdits();
+    void paragraphEdit();
+    void paragraphSplit();
+    void paragraphRemoved();
+    void blocksAfterEditMoved();
+    void listItemEdit();
+    void headingEdit();
+    void emojiMoved();
+    void unclosedFence();
+    void referenceLinkFallback();
+
+private:
+    QSharedPointer<MD::Document> parse(QString md);
+    QSharedPointer<MD::Document> reparse(QString before, const QString &after, const MdEditor::TextEdit &edit);
+    MdEditor::TextEdit makeEdit(const qsizetype firstLine, const qsizetype lastLine, const qsizetype lineDelta);
+
+    // md4qt
+    MD::Parser m_md4qtParser;
+    const QString dummyPath = QStringLiteral("/home/dummy/");
+    const QString dummyName = QStringLiteral("note.md");
+};
+
+/* Settings Data */
+void IncrementalParsingTest::initTestCase()
+{
+    auto inlineParsers = setInlineParsers<EmojiPlugin::EmojiParser>();
+    m_md4qtParser.setInlineParsers(inlineParsers);
+}
+
+/* Helpers */
+QSharedPointer<MD::Document> IncrementalParsingTest::parse(QString md)
+{
+    QTextStream s(&md, QIODeviceBase::ReadOnly);
+    return m_md4qtParser.parse(s, dummyPath, dummyName);
+}
+
+QSharedPointer<MD::Document> IncrementalParsingTest::reparse(QString before, const QString &after, const MdEditor::TextEdit &edit)
+{
+    const auto previousDoc = parse(before);
+    return incrementalParser::reparse(m_md4qtParser, previousDoc, MdEditor::TextSnapshot::fromText(after), edit, dummyPath, dummyName);
+}
+
+MdEditor::TextEdit IncrementalParsingTest::makeEdit(const qsizetype firstLine, const qsizetype lastLine, const qsizetype lineDelta)
+{
+    MdEditor::TextEdit edit;
+    edit.firstLine = firstLine;
+    edit.lastLine = lastLine;
+    edit.lineDelta = lineDelta;
+    return edit;
+}
+
+/* TEST */
+void IncrementalParsingTest::mergeEdits()
+{
+    auto edit = makeEdit(4, 4, 2);
+    // Typing on the second inserted line
+    edit.merge(makeEdit(6, 6, 0));
+    QCOMPARE_EQ(edit.firstLine, 4);
+    QCOMPARE_EQ(edit.lastLine, 4);
+    QCOMPARE_EQ(edit.lineDelta, 2);
+
+    // Removing lines further in the text
+    edit.merge(makeEdit(10, 12, -2));
+    QCOMPARE_EQ(edit.firstLine, 4);
+    QCOMPARE_EQ(edit.lastLine, 10);
+    QCOMPARE_EQ(edit.lineDelta, 0);
+
+    edit.merge(MdEditor::TextEdit::fullEdit());
+    QVERIFY(edit.full);
+
+    MdEditor::TextEdit empty;
+    QVERIFY(empty.isEmpty());
+    empty.merge(makeEdit(1, 1, 0));
+    QCOMPARE_EQ(empty.firstLine, 1);
+}
+
+/*
+# Title
+
+First paragraph
+
+Second paragraph
+
+Third paragraph
+*/
+void IncrementalParsingTest::paragraphEdit()
+{
+    const QString before = QStringLiteral("# Title\n\nFirst paragraph\n\nSecond paragraph\n\nThird paragraph");
+    const QString after = QStringLiteral("# Title\n\nFirst paragraph\n\nSecond *edited* paragraph\n\nThird paragraph");
+
+    const auto doc = reparse(before, after, makeEdit(4, 4, 0));
+    if (!doc) {
+        QFAIL("paragraphEdit: The edit should be handled incrementally");
+    }
+    QVERIFY(incrementalParser::sameDocument(doc, parse(after)));
+}
+
+void IncrementalParsingTest::paragraphSplit()
+{
+    const QString before = QStringLiteral("# Title\n\nFirst paragraph\n\nSecond paragraph\n\nThird paragraph");
+    const QString after = QStringLiteral("# Title\n\nFirst paragraph\n\nSecond\n\nparagraph\n\nThird paragraph");
+
+    const auto doc = reparse(before, after, makeEdit(4, 4, 2));
+    if (!doc) {
+        QFAIL("paragraphSplit: The edit should be handled incrementally");
+    }
+    QVERIFY(incrementalParser::sameDocument(doc, parse(after)));
+}
+
+void IncrementalParsingTest::paragraphRemoved()
+{
+    const QString before = QStringLiteral("# Title\n\nFirst paragraph\n\nSecond paragraph\n\nThird paragraph");
+    const QString after = QStringLiteral("# Title\n\nSecond paragraph\n\nThird paragraph");
+
+    const auto doc = reparse(before, after, makeEdit(2, 4, -2));
+    if (!doc) {
+        QFAIL("paragraphRemoved: The edit should be handled incrementally");
+    }
+    QVERIFY(incrementalParser::sameDocument(doc, parse(after)));
+}
+
+void IncrementalParsingTest::blocksAfterEditMoved()
+{
+    const QString before = QStringLiteral("# Title\n\nA\n\nB\n\nC\n\nD *with style*\n\n## Other title");
+    const QString after = QStringLiteral("# Title\n\nA\n\nB\n\nB2\n\nC\n\nD *with style*\n\n## Other title");
+
+    const auto previousDoc = parse(before);
+    const auto previousD = previousDoc->items().at(5);
+
+    const auto doc = incrementalParser::reparse(m_md4qtParser, previousDoc, MdEditor::TextSnapshot::fromText(after), makeEdit(4, 4, 2), dummyPath, dummyName);
+    if (!doc) {
+        QFAIL("blocksAfterEditMoved: The edit should be handled incrementally");
+    }
+    QVERIFY(incrementalParser::sameDocument(doc, parse(after)));
+
+    // The previous document must be left untouched
+    QCOMPARE_EQ(previousD->startLine(), 8);
+    QCOMPARE_EQ(doc->items().at(6)->startLine(), 10);
+}
+
+/*
+Intro
+
+- one
+- two
+- three
+
+Outro
+
+End
+*/
+void IncrementalParsingTest::listItemEdit()
+{
+    const QString before = QStringLiteral("Intro\n\n- one\n- two\n- three\n\nOutro\n\nEnd");
+    const QString after = QStringLiteral("Intro\n\n- one\n- two **bold**\n- three\n\nOutro\n\nEnd");
+
+    const auto doc = reparse(before, after, makeEdit(3, 3, 0));
+    if (!doc) {
+        QFAIL("listItemEdit: The edit should be handled incrementally");
+    }
+    QVERIFY(incrementalParser::sameDocument(doc, parse(after)));
+}
+
+void IncrementalParsingTest::headingEdit()
+{
+    const QString before = QStringLiteral("# Title\n\nFirst paragraph\n\n## Sub title\n\nSecond paragraph\n\nThird paragraph");
+    const QString after = QStringLiteral("# Title\n\nFirst paragraph\n\n## Sub title changed\n\nSecond paragraph\n\nThird paragraph");
+
+    const auto doc = reparse(before, after, makeEdit(4, 4, 0));
+    if (!doc) {
+        QFAIL("headingEdit: The edit should be handled incrementally");
+    }
+    QVERIFY(incrementalParser::sameDocument(doc, parse(after)));
+}
+
+void IncrementalParsingTest::emojiMoved()
+{
+    const QString before = QStringLiteral("First paragraph\n\nSecond paragraph\n\nThird paragraph\n\nSome :woman: emoji");
+    const QString after = QStringLiteral("First paragraph\n\nSecond paragraph\nstill second\n\nThird paragraph\n\nSome :woman: emoji");
+
+    const auto doc = reparse(before, after, makeEdit(2, 2, 1));
+    if (!doc) {
+        QFAIL("emojiMoved: The edit should be handled incrementally");
+    }
+    QVERIFY(incrementalParser::sameDocument(doc, parse(after)));
+}
+
+void IncrementalParsingTest::textSnapshot()
+{
+    QStringList lines;
+    for (int i = 0; i < 200; ++i) {
+        lines.append(QString::number(i));
+    }
+    const auto before = MdEditor::TextSnapshot::fromText(lines.join(QLatin1Char('\n')));
+
+    const auto after = before.replaced(100, 2, {QStringLiteral("a"), QStringLiteral("b"), QStringLiteral("c")});
+    lines.remove(100, 2);
+    lines.insert(100, QStringLiteral("a"));
+    lines.insert(101, QStringLiteral("b"));
+    lines.insert(102, QStringLiteral("c"));
+
+    QCOMPARE(after.lineCount(), qsizetype(201));
+    QCOMPARE(after.toString(), lines.join(QLatin1Char('\n')));
+    QCOMPARE(after.text(99, 103), QStringLiteral("99\na\nb\nc\n102"));
+
+    // The previous snapshot is untouched
+    QCOMPARE(before.lineCount(), qsizetype(200));
+    QCOMPARE(before.line(100), QStringLiteral("100"));
+
+    const auto emptied = before.replaced(0, 200, {});
+    QCOMPARE(emptied.lineCount(), qsizetype(1));
+    QCOMPARE(emptied.toString(), QString());
+}
+
+void IncrementalParsingTest::unclosedFence()
+{
+    const QString before = QStringLiteral("Intro\n\nText\n\nMore\n\nEnd");
+    const QString after = QStringLiteral("Intro\n\n```\n\nMore\n\nEnd");
+
+    const auto doc = reparse(before, after, makeEdit(2, 2, 0));
+    if (doc) {
+        QFAIL("unclosedFence: An unclosed fence must trigger a full parsing");
+    }
+}
+
+void IncrementalParsingTest::referenceLinkFallback()
+{
+    const QString before = QStringLiteral("A [link][ref]\n\nText\n\n[ref]: https://kde.org");
+    const QString after = QStringLiteral("A [link][ref]\n\nOther text\n\n[ref]: https://kde.org");
+
+    const auto doc = reparse(before, after, makeEdit(2, 2, 0));
+    if (doc) {
+        QFAIL("referenceLinkFallback: Reference links must trigger a full parsing");
+    }
+}
+QTEST_MAIN(IncrementalParsingTest)
+#include "incrementalParsingTest.moc"
@@ -0,0 +1,80 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "logic/parser/previewSections.h"
+
+// Qt include
+#include <QObject>
+#include <QTextStream>
+#include <QtTest/QTest>
+
+#include <md4qt/src/doc.h>
+#include <md4qt/src/parser.h>
+
+class PreviewSectionsTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void visibleSection();
+    void wholeNote();
+    void footnotesKept();
+
+private:
+    QSharedPointer<MD::Document> parse(QString md);
+
+    // md4qt
+    MD::Parser m_md4qtParser;
+    const QString dummyPath = QStringLiteral("/home/dummy/");
+    const QString dummyName = QStringLiteral("note.md");
+};
+
+/* Helpers */
+QSharedPointer<MD::Document> PreviewSectionsTest::parse(QString md)
+{
+    QTextStream s(&md, QIODeviceBase::ReadOnly);
+    return m_md4qtParser.parse(s, dummyPath, dummyName);
+}
+
+/* TEST */
+void PreviewSectionsTest::visibleSection()
+{
+    // Lines 0 to 4, 6 to 10 and 12 to 16
+    const QString md = QStringLiteral("# First\n\nA\n\nB\n\n# Second\n\nC\n\nD\n\n# Third\n\nE\n\nF");
+    const auto doc = parse(md);
+
+    const auto sections = previewSections::around(doc, 9, 9);
+    // The anchor and the second section
+    QCOMPARE_EQ(sections.doc->items().size(), 4);
+    QVERIFY(sections.doc->items().at(1)->type() == MD::ItemType::Heading);
+    QCOMPARE_EQ(sections.doc->items().at(1)->startLine(), 6);
+    QCOMPARE_EQ(sections.firstLine, 5);
+    QCOMPARE_EQ(sections.lastLine, 11);
+    QVERIFY(sections.covers(6, 10));
+    QVERIFY(!sections.covers(6, 12));
+}
+
+void PreviewSectionsTest::wholeNote()
+{
+    const QString md = QStringLiteral("# First\n\nA\n\n# Second\n\nB");
+    const auto doc = parse(md);
+
+    const auto sections = previewSections::around(doc, 0, 6);
+    QCOMPARE_EQ(sections.doc, doc);
+}
+
+void PreviewSectionsTest::footnotesKept()
+{
+    const QString md = QStringLiteral("# First\n\nA[^1]\n\n# Second\n\nB\n\n[^1]: The footnote");
+    const auto doc = parse(md);
+
+    const auto sections = previewSections::around(doc, 0, 2);
+    QVERIFY(sections.doc != doc);
+    QCOMPARE_EQ(sections.doc->footnotesMap().size(), 1);
+    QCOMPARE_EQ(sections.doc->labeledHeadings().size(), doc->labeledHeadings().size());
+}
+
+QTEST_MAIN(PreviewSectionsTest)
+#include "previewSectionsTest.moc"
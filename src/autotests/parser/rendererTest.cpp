@@ -0,0 +1,130 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "logic/parser/renderer.h"
+#include "logic/parser/textSnapshot.h"
+
+// Qt include
+#include <QObject>
+#include <QTextStream>
+#include <QtTest/QTest>
+
+#include <md4qt/src/doc.h>
+#include <md4qt/src/parser.h>
+
+// C++ include
+#include <algorithm>
+
+class RendererTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void blocksMatchHtml();
+    void footnotesBlock();
+    void rawHtmlBlock();
+    void cachedBlocks_data();
+    void cachedBlocks();
+
+private:
+    QSharedPointer<MD::Document> parse(QString md);
+
+    // md4qt
+    MD::Parser m_md4qtParser;
+    const QString dummyPath = QStringLiteral("/home/dummy/");
+    const QString dummyName = QStringLiteral("note.md");
+    const QString backLink = QStringLiteral("&nbsp;&hookleftarrow;&nbsp;");
+};
+
+/* Helpers */
+QSharedPointer<MD::Document> RendererTest::parse(QString md)
+{
+    QTextStream s(&md, QIODeviceBase::ReadOnly);
+    return m_md4qtParser.parse(s, dummyPath, dummyName);
+}
+
+/* TEST */
+void RendererTest::blocksMatchHtml()
+{
+    const QString md = QStringLiteral(
+        "# Title\n\nSome **bold** text\n\n- [ ] task\n- item\n\n```cpp\nint a;\n```\n\n> quote\n\n---\n\n| A | B |\n|---|---|\n| 1 | 2 |\n\n![image](./image.png)");
+    const auto doc = parse(md);
+
+    Renderer renderer;
+    renderer.setNoteDir(dummyPath);
+    const QString html = renderer.toHtml(doc, backLink);
+    const QStringList blocks = renderer.toHtmlBlocks(doc, backLink);
+
+    // The anchor of the document and one block per top level item
+    QCOMPARE_EQ(blocks.size(), doc->items().size());
+    QCOMPARE_EQ(blocks.join(QString()), html);
+}
+
+void RendererTest::footnotesBlock()
+{
+    const QString md = QStringLiteral("Some text[^1]\n\nMore text[^1]\n\n[^1]: The footnote");
+    const auto doc = parse(md);
+
+    Renderer renderer;
+    const QString html = renderer.toHtml(doc, backLink);
+    const QStringList blocks = renderer.toHtmlBlocks(doc, backLink);
+
+    QCOMPARE_EQ(blocks.size(), doc->items().size() + 1);
+    QVERIFY(blocks.constLast().startsWith(QStringLiteral("<section class=\"footnotes\">")));
+    QCOMPARE_EQ(blocks.join(QString()), html);
+}
+
+void RendererTest::rawHtmlBlock()
+{
+    const QString md = QStringLiteral("Before\n\n<details>\n<summary>More</summary>\n\nSome **hidden** text\n\n- item\n\n</details>\n\nAfter");
+    const auto doc = parse(md);
+
+    Renderer renderer;
+    const QString html = renderer.toHtml(doc, backLink);
+    const QStringList blocks = renderer.toHtmlBlocks(doc, backLink);
+
+    // The page parses each block on its own, the markdown between the tags must stay inside `<details>`
+    const auto detailsBlock = std::find_if(blocks.cbegin(), blocks.cend(), [](const QString &block) {
+        return block.contains(QStringLiteral("<details>"));
+    });
+    QVERIFY(detailsBlock != blocks.cend());
+    QVERIFY(detailsBlock->contains(QStringLiteral("<strong>hidden</strong>")));
+    QVERIFY(detailsBlock->contains(QStringLiteral("</details>")));
+    QVERIFY(!detailsBlock->contains(QStringLiteral("After")));
+    QCOMPARE_EQ(blocks.join(QString()), html);
+}
+
+void RendererTest::cachedBlocks_data()
+{
+    QTest::addColumn<QString>("before");
+    QTest::addColumn<QString>("after");
+
+    QTest::newRow("edited paragraph") << QStringLiteral("# Title\n\nFirst\n\nSecond\n\n- item") << QStringLiteral("# Title\n\nFirst\n\nSecond edited\n\n- item");
+    QTest::newRow("moved blocks") << QStringLiteral("First\n\nSecond") << QStringLiteral("New\n\nFirst\n\nSecond");
+    QTest::newRow("heading label") << QStringLiteral("# Same\n\ntext\n\n# Same") << QStringLiteral("text\n\n# Same");
+    QTest::newRow("labeled link") << QStringLiteral("[link][label]\n\n[label]: https://kde.org")
+                                  << QStringLiteral("[link][label]\n\n[label]: https://invent.kde.org");
+    QTest::newRow("footnotes") << QStringLiteral("Text[^1]\n\nOther[^2]\n\n[^1]: One\n\n[^2]: Two")
+                               << QStringLiteral("Other[^2]\n\n[^1]: One\n\n[^2]: Two");
+    QTest::newRow("raw html") << QStringLiteral("<details>\n\ntext\n\n</details>\n\nAfter") << QStringLiteral("<details>\n\ntext edited\n\n</details>\n\nAfter");
+}
+
+void RendererTest::cachedBlocks()
+{
+    QFETCH(QString, before);
+    QFETCH(QString, after);
+
+    Renderer renderer;
+    renderer.setNoteDir(dummyPath);
+    renderer.toHtmlBlocks(parse(before), MdEditor::TextSnapshot::fromText(before), backLink);
+
+    // The reused blocks must give the same HTML as a full rendering
+    const auto doc = parse(after);
+    const QStringList blocks = renderer.toHtmlBlocks(doc, MdEditor::TextSnapshot::fromText(after), backLink);
+    QCOMPARE(blocks, Renderer().toHtmlBlocks(doc, backLink));
+}
+
+QTEST_MAIN(RendererTest)
+#include "rendererTest.moc"
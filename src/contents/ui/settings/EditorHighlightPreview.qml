@@ -34,6 +34,39 @@ ColumnLayout {
         }
     }
 
+    FormCard.FormSpinBoxDelegate {
+        id: sliceBudgetSpin
+
+        label: i18nc("@label:spinbox", "Highlighting time slice (ms)")
+
+        from: 0
+        to: 50
+        value: KleverConfig.highlightSliceBudget
+
+        Layout.fillWidth: true
+
+        onValueChanged: if (KleverConfig.highlightSliceBudget != value) {
+            KleverConfig.highlightSliceBudget = value
+        }
+    }
+
+    FormCard.FormSpinBoxDelegate {
+        id: largeNoteSpin
+
+        label: i18nc("@label:spinbox", "Large note mode from (KiB)")
+
+        from: 0
+        to: 65536
+        stepSize: 256
+        value: KleverConfig.largeNoteThreshold
+
+        Layout.fillWidth: true
+
+        onValueChanged: if (KleverConfig.largeNoteThreshold != value) {
+            KleverConfig.largeNoteThreshold = value
+        }
+    }
+
     FormCard.FormSpinBoxDelegate {
         id: scaleSpin
 
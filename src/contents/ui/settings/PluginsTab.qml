@@ -119,6 +119,15 @@ ColumnLayout {
                 text: i18nc("@label:combobox", "Highlighter style")
                 model: HighlightHelper.getHighlighterStyle(highlighterCombobox.currentValue)
 
+                // The styles can change when the highlighters are checked again in the background
+                Connections {
+                    target: HighlightHelper
+
+                    function onHighlightersChanged() {
+                        styleCombobox.model = Qt.binding(() => HighlightHelper.getHighlighterStyle(highlighterCombobox.currentValue))
+                    }
+                }
+
                 onCurrentValueChanged: {
                     if (!styleCombobox.configStyleSet) {
                         const baseIndex = 0;
@@ -166,9 +166,9 @@ RowLayout {
         id: editorHandlerConnections
         target: EditorHandler
 
-        function onRenderingFinished(content) {
+        function onRenderingFinished(blockIds, blocks) {
             if (applicationWindow().isMainPage()) {
-                contentLink.text = content
+                contentLink.setBlocks(blockIds, blocks)
             }
         }
     }
@@ -21,8 +21,21 @@ ScrollView {
 
     onPathChanged: {
         textArea.tempBuff = true ;
-        textArea.text = DocumentHandler.readFile(path);
+        textArea.text = EditorHandler.startLoading(DocumentHandler.readFile(path));
         modified = false ;
+        updateVisibleArea()
+        if (EditorHandler.loadingNote) {
+            noteLoaderTimer.start()
+        }
+    }
+    onHeightChanged: updateVisibleArea()
+
+    Connections {
+        target: view.contentItem
+
+        function onContentYChanged() {
+            view.updateVisibleArea()
+        }
     }
 
     TextArea{
@@ -33,6 +46,8 @@ ScrollView {
         font: KleverConfig.editorFont
         wrapMode: TextEdit.Wrap
         persistentSelection: true
+        // The rest of a large note is still being appended
+        readOnly: EditorHandler.loadingNote
 
         background: Item {}
 
@@ -50,7 +65,9 @@ ScrollView {
         }
         onTextChanged: {
             if (!tempBuff) {
-                modified = true
+                if (!EditorHandler.loadingNote) {
+                    modified = true
+                }
             } else {
                 cursorPosition = length
                 tempBuff = false
@@ -85,6 +102,20 @@ ScrollView {
         }
     }
 
+    Timer {
+        id: noteLoaderTimer
+
+        // One chunk per event loop iteration, the UI stays responsive while loading
+        interval: 0
+        repeat: true
+
+        onTriggered: {
+            if (!EditorHandler.loadNextChunk()) {
+                stop()
+            }
+        }
+    }
+
     Timer {
         id: noteSaverTimer
 
@@ -95,6 +126,11 @@ ScrollView {
         }
     }
 
+    function updateVisibleArea() {
+        const top = view.contentItem.contentY
+        EditorHandler.setVisibleArea(textArea.positionAt(0, top), textArea.positionAt(textArea.width, top + view.height))
+    }
+
     function saveNote (text, path) {
         if (modified) {
             DocumentHandler.writeFile(text, path)
@@ -6,15 +6,26 @@
 // KleverNotes include
 #include "editorHighlighter.hpp"
 #include "logic/editor/editorTextManipulation.hpp"
+#include "logic/editor/editorTrace.hpp"
+#include "logic/editor/parseScheduler.hpp"
+#include "logic/parser/documentRelease.h"
 #include "logic/parser/parser.h"
-#include "logic/parser/renderer.h"
+#include "logic/parser/renderWorker.h"
 
 // Qt include
 #include <QColor>
 #include <QRegularExpression>
 #include <QTextBlock>
 
+// C++ include
+#include <algorithm>
+#include <utility>
+
 using namespace Qt::Literals::StringLiterals;
+
+// Characters appended to the TextArea per event loop iteration while loading a large note
+static constexpr qsizetype LOADING_CHUNK_SIZE = 64 * 1024;
+
 namespace MdEditor
 {
 
@@ -23,14 +34,15 @@ EditorHandler::EditorHandler(QObject *parent)
     , m_config(KleverConfig::self())
     , m_parser(new Parser())
     , m_parsingThread(new QThread(this))
-    , m_renderer(new Renderer())
-    , m_pluginHelper(new PluginHelper(this))
+    , m_parseScheduler(new ParseScheduler(this))
+    , m_renderWorker(new RenderWorker(this))
+    , m_renderingThread(new QThread(this))
     , m_editorHighlighter(new EditorHighlighter(this))
     , m_cursorMoveTimer(new QTimer(this))
+    , m_highlightTimer(new QTimer(this))
 {
-    m_renderer->addPluginHelper(m_pluginHelper);
-
     connectParser();
+    connectRenderer();
 
     connect(m_config, &KleverConfig::previewVisibleChanged, this, &EditorHandler::renderPreviewStateChanged);
     changeRenderPreviewState();
@@ -56,16 +68,35 @@ EditorHandler::~EditorHandler()
 {
     m_parsingThread->quit();
     m_parsingThread->wait();
+
+    m_renderingThread->quit();
+    m_renderingThread->wait();
 }
 
 // Connections
 // ===========
 void EditorHandler::connectParser()
 {
+    m_parser->setGeneration(m_parseGeneration);
+    m_parsingThread->setObjectName(QStringLiteral("Parsing"));
     m_parser->moveToThread(m_parsingThread);
     connect(this, &EditorHandler::askForParsing, m_parser, &Parser::onData, Qt::QueuedConnection);
     connect(m_parser, &Parser::done, this, &EditorHandler::onParsingDone, Qt::QueuedConnection);
     m_parsingThread->start();
+
+    connect(m_parseScheduler, &ParseScheduler::parseRequested, this, &EditorHandler::onParseRequested);
+    connect(m_parseScheduler, &ParseScheduler::budgetChanged, this, &EditorHandler::parseBudgetChanged);
+    connect(m_parseScheduler, &ParseScheduler::droppedRequestsChanged, this, &EditorHandler::droppedParseRequestsChanged);
+}
+
+void EditorHandler::connectRenderer()
+{
+    m_renderingThread->setObjectName(QStringLiteral("Rendering"));
+    m_renderWorker->moveToThread(m_renderingThread);
+    connect(m_renderingThread, &QThread::finished, m_renderWorker, &QObject::deleteLater);
+    connect(this, &EditorHandler::askForRendering, m_renderWorker, &RenderWorker::onData, Qt::QueuedConnection);
+    connect(m_renderWorker, &RenderWorker::done, this, &EditorHandler::onRenderingDone, Qt::QueuedConnection);
+    m_renderingThread->start();
 }
 
 void EditorHandler::connectPlugins()
@@ -73,9 +104,20 @@ void EditorHandler::connectPlugins()
     // Code Highlight
     connect(m_config, &KleverConfig::codeSynthaxHighlightEnabledChanged, this, &EditorHandler::codeHighlightEnabledChanged);
     codeHighlightEnabledChanged();
+    connect(m_config, &KleverConfig::codeSynthaxHighlighterChanged, this, &EditorHandler::newHighlightStyle);
     connect(m_config, &KleverConfig::codeSynthaxHighlighterStyleChanged, this, &EditorHandler::newHighlightStyle);
     newHighlightStyle();
 
+    // NoteMapper
+    connect(m_config, &KleverConfig::noteMapEnabledChanged, this, &EditorHandler::noteMapEnabledChanged);
+    noteMapEnabledChanged();
+
+    // Parser
+    connect(m_config, &KleverConfig::quickEmojiEnabledChanged, this, &EditorHandler::parserSettingsChanged);
+    connect(m_config, &KleverConfig::emojiToneChanged, this, &EditorHandler::parserSettingsChanged);
+    connect(m_config, &KleverConfig::noteMapEnabledChanged, this, &EditorHandler::parserSettingsChanged);
+    parserSettingsChanged();
+
     // Puml
     connect(m_config, &KleverConfig::pumlEnabledChanged, this, &EditorHandler::pumlEnabledChanged);
     pumlEnabledChanged();
@@ -95,14 +137,26 @@ void EditorHandler::connectHighlight()
 
     connect(m_config, &KleverConfig::tagSizeScaleChanged, this, &EditorHandler::tagScaleChanged);
     tagScaleChanged();
+
+    connect(m_config, &KleverConfig::highlightSliceBudgetChanged, this, &EditorHandler::highlightSliceBudgetChanged);
+    highlightSliceBudgetChanged();
+
+    connect(m_config, &KleverConfig::largeNoteThresholdChanged, this, &EditorHandler::largeNoteThresholdChanged);
 }
 
 void EditorHandler::connectTimer()
 {
     m_cursorMoveTimer->setSingleShot(true);
-    m_cursorMoveTimer->setInterval(200);
+    // The delims pairs are cached per parsing, a cursor move is only a lookup
+    m_cursorMoveTimer->setInterval(50);
 
     connect(m_cursorMoveTimer, &QTimer::timeout, this, &EditorHandler::cursorMovedTimeOut);
+
+    // Each slice is done from the event loop, letting the user input go first
+    m_highlightTimer->setSingleShot(true);
+    m_highlightTimer->setInterval(0);
+
+    connect(m_highlightTimer, &QTimer::timeout, this, &EditorHandler::highlightTimeOut);
 }
 // !Connections
 
@@ -129,8 +183,13 @@ void EditorHandler::setDocument(QQuickTextDocument *document)
 
     if (document) {
         m_qQuickDocument = document;
+        connect(m_qQuickDocument->textDocument(), &QTextDocument::contentsChange, this, &EditorHandler::onContentsChange);
         connect(m_qQuickDocument->textDocument(), &QTextDocument::contentsChanged, this, &EditorHandler::parseDoc);
         m_document = m_qQuickDocument->textDocument();
+        m_blockCount = m_document->blockCount();
+        m_textSnapshot = TextSnapshot::fromText(m_document->toPlainText());
+        m_pendingEdit = TextEdit::fullEdit();
+        m_editorHighlighter->textEdited(m_pendingEdit);
         Q_EMIT documentChanged();
     }
 }
@@ -206,25 +265,79 @@ void EditorHandler::setSelectionEnd(const int position)
 // Parser
 void EditorHandler::parseDoc()
 {
-    if (!m_highlighting) {
-        parse(m_document->toPlainText());
+    // A large note being loaded is parsed once complete
+    if (!m_highlighting && !m_loadingNote) {
+        editorTrace::instant("contentsChanged");
+        // Set with the edit, the parsing can be debounced while the cursor moves
+        m_textChanged = !m_noteFirstHighlight;
+        m_cursorMoveTimer->stop();
+        // The text of the parsing in flight, if any, is now outdated
+        m_parseGeneration->store(nextParseCount());
+        m_parseScheduler->requestParse();
     }
 }
 
-void EditorHandler::parse(const QString &src)
-{
-    m_textChanged = !m_noteFirstHighlight;
-    if (m_pluginHelper) {
-        m_pluginHelper->clearPluginsInfo();
-    }
+void EditorHandler::parse(const TextSnapshot &snapshot)
+{
+    m_parseCount = nextParseCount();
+    m_parseGeneration->store(m_parseCount);
+
+    m_parseTimer.start();
+    editorTrace::asyncBegin("edit", m_parseCount);
+    editorTrace::instant("askForParsing", m_parseCount);
+    Q_EMIT askForParsing(snapshot, m_noteDir, m_noteName, m_pendingEdit, m_parseCount);
+    m_pendingEdit = TextEdit();
+}
+
+void EditorHandler::updateTextSnapshot(const TextEdit &edit)
+{
+    if (!edit.full && m_textSnapshot.lineCount() != 0) {
+        // Only the edited blocks are read, with the same conversions as QTextDocument::toPlainText
+        QStringList lines;
+        const int lastLine = edit.lastLine + edit.lineDelta;
+        for (auto block = m_document->findBlockByNumber(edit.firstLine); block.isValid() && block.blockNumber() <= lastLine; block = block.next()) {
+            QString line = block.text();
+            for (auto &c : line) {
+                switch (c.unicode()) {
+                case 0xfdd0: // QTextBeginningOfFrame
+                case 0xfdd1: // QTextEndOfFrame
+                case QChar::ParagraphSeparator:
+                case QChar::LineSeparator:
+                    c = QLatin1Char('\n');
+                    break;
+                case QChar::Nbsp:
+                    c = QLatin1Char(' ');
+                    break;
+                default:
+                    break;
+                }
+            }
+            lines.append(line);
+        }
 
-    if (m_parseCount == std::numeric_limits<unsigned long long int>::max()) {
-        m_parseCount = 0;
+        m_textSnapshot = m_textSnapshot.replaced(edit.firstLine, edit.lastLine - edit.firstLine + 1, lines);
+        if (m_textSnapshot.lineCount() == m_document->blockCount()) {
+            return;
+        }
     }
 
-    ++m_parseCount;
+    // Fallback, the whole text is read again
+    m_textSnapshot = TextSnapshot::fromText(m_document->toPlainText());
+}
+
+unsigned long long int EditorHandler::nextParseCount() const
+{
+    return m_parseCount == std::numeric_limits<unsigned long long int>::max() ? 1 : m_parseCount + 1;
+}
+
+int EditorHandler::parseBudget() const
+{
+    return m_parseScheduler->budget();
+}
 
-    Q_EMIT askForParsing(src, m_noteDir, m_noteName, m_parseCount);
+int EditorHandler::droppedParseRequests() const
+{
+    return m_parseScheduler->droppedRequests();
 }
 
 QString EditorHandler::getNotePath() const
@@ -252,23 +365,25 @@ void EditorHandler::setNoteName(const QString &noteName)
 
 QString EditorHandler::getNoteDir() const
 {
-    return m_renderer->getNoteDir();
+    return m_noteDir;
 }
 
 void EditorHandler::setNoteDir(const QString &noteDir)
 {
     m_noteDir = noteDir;
-    m_renderer->setNoteDir(noteDir);
-
-    if (m_pluginHelper) {
-        // We do this here because we're sure to be in another note
-        m_pluginHelper->clearPluginsPreviousInfo();
-
-        m_pluginHelper->mapperParserUtils()->setNotePath(noteDir);
-    }
+    m_pendingEdit = TextEdit::fullEdit();
+    QMetaObject::invokeMethod(
+        m_renderWorker,
+        [worker = m_renderWorker, noteDir, storagePath = KleverConfig::storagePath()]() {
+            worker->setNoteDir(noteDir, storagePath);
+        },
+        Qt::QueuedConnection);
     m_noteFirstHighlight = true;
 
-    Q_EMIT renderingFinished({});
+    // Renders of the previous note still running will be discarded
+    m_renderCount = 0;
+    Q_EMIT renderingFinished({}, {});
+    m_parseScheduler->reset();
     parseDoc();
 }
 
@@ -278,12 +393,17 @@ void EditorHandler::setNoteDir(const QString &noteDir)
 void EditorHandler::renderDoc()
 {
     if (m_currentMdDoc) {
-        const auto html = m_renderer->toHtml(m_currentMdDoc, QStringLiteral("&nbsp;&hookleftarrow;&nbsp;"));
-
-        if (m_pluginHelper) {
-            m_pluginHelper->postTokChanges();
+        m_renderCount = m_currentParseCount;
+        editorTrace::instant("askForRendering", m_currentParseCount);
+
+        if (m_largeNote) {
+            const auto sections = previewSections::around(m_currentMdDoc, m_firstVisibleLine, m_lastVisibleLine);
+            m_renderedFirstLine = sections.firstLine;
+            m_renderedLastLine = sections.lastLine;
+            Q_EMIT askForRendering(sections.doc, m_currentTextSnapshot, m_currentParseCount);
+        } else {
+            Q_EMIT askForRendering(m_currentMdDoc, m_currentTextSnapshot, m_currentParseCount);
         }
-        Q_EMIT renderingFinished(html);
     }
 }
 
@@ -300,6 +420,117 @@ void EditorHandler::changeRenderPreviewState(const bool _enabled)
 }
 // !Rendering
 
+// Large note
+bool EditorHandler::largeNote() const
+{
+    return m_largeNote;
+}
+
+bool EditorHandler::loadingNote() const
+{
+    return m_loadingNote;
+}
+
+QString EditorHandler::startLoading(const QString &text)
+{
+    m_loadingText.clear();
+    m_loadingPosition = 0;
+
+    const qsizetype threshold = qsizetype(m_config->largeNoteThreshold()) * 1024;
+    if (threshold <= 0 || text.size() < threshold) {
+        // Another note could still be loading
+        if (m_loadingNote && m_document) {
+            m_document->setUndoRedoEnabled(true);
+        }
+        setLoadingNote(false);
+        return text;
+    }
+
+    // Set before the first chunk reaches the document, its size alone would leave the mode
+    setLargeNote(true);
+    setLoadingNote(true);
+    // Undoing a chunk would truncate the note
+    if (m_document) {
+        m_document->setUndoRedoEnabled(false);
+    }
+    m_loadingText = text;
+    return loadingChunk();
+}
+
+bool EditorHandler::loadNextChunk()
+{
+    if (m_document && m_loadingPosition < m_loadingText.size()) {
+        QTextCursor cursor(m_document);
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText(loadingChunk());
+        return true;
+    }
+
+    m_loadingText.clear();
+    m_loadingPosition = 0;
+    if (m_loadingNote) {
+        setLoadingNote(false);
+        if (m_document) {
+            // Disabling it cleared the stack, the loaded note can't be undone
+            m_document->setUndoRedoEnabled(true);
+        }
+        parseDoc();
+    }
+    return false;
+}
+
+QString EditorHandler::loadingChunk()
+{
+    qsizetype end = m_loadingPosition + LOADING_CHUNK_SIZE;
+    if (end < m_loadingText.size()) {
+        const qsizetype lineEnd = m_loadingText.indexOf(QLatin1Char('\n'), end);
+        end = lineEnd == -1 ? m_loadingText.size() : lineEnd + 1;
+    } else {
+        end = m_loadingText.size();
+    }
+
+    const QString chunk = m_loadingText.mid(m_loadingPosition, end - m_loadingPosition);
+    m_loadingPosition = end;
+    return chunk;
+}
+
+void EditorHandler::setLoadingNote(const bool loading)
+{
+    if (m_loadingNote != loading) {
+        m_loadingNote = loading;
+        Q_EMIT loadingNoteChanged();
+    }
+}
+
+void EditorHandler::updateLargeNote()
+{
+    if (!m_document || m_loadingNote) {
+        return;
+    }
+
+    const qsizetype threshold = qsizetype(m_config->largeNoteThreshold()) * 1024;
+    const qsizetype size = m_document->characterCount();
+    // The mode is left a bit below the threshold, typing around it doesn't switch back and forth
+    setLargeNote(0 < threshold && (m_largeNote ? threshold * 9 / 10 <= size : threshold <= size));
+}
+
+void EditorHandler::setLargeNote(const bool largeNote)
+{
+    if (m_largeNote == largeNote) {
+        return;
+    }
+
+    m_largeNote = largeNote;
+    m_editorHighlighter->setVisibleOnly(m_largeNote);
+    if (m_largeNote) {
+        m_highlightTimer->stop();
+        m_surroundingDelims.clear();
+        Q_EMIT surroundingDelimsChanged({});
+    }
+    Q_EMIT largeNoteChanged();
+}
+// !Large note
+
 // Highlight
 // =========
 void EditorHandler::cacheAndHighlightSyntax(QSharedPointer<MD::Document> doc)
@@ -309,6 +540,35 @@ void EditorHandler::cacheAndHighlightSyntax(QSharedPointer<MD::Document> doc)
         m_editorHighlighter->cacheAndHighlight(doc, m_config->editorHighlightEnabled());
         updateSurroundingDelims();
         m_highlighting = false;
+
+        // The lines of a large note are highlighted once visible
+        if (!m_largeNote && m_editorHighlighter->hasPendingHighlight()) {
+            m_highlightTimer->start();
+        } else {
+            m_highlightTimer->stop();
+        }
+    }
+}
+
+void EditorHandler::setVisibleArea(const int firstPosition, const int lastPosition)
+{
+    if (!m_document) {
+        return;
+    }
+
+    const int firstLine = m_document->findBlock(firstPosition).blockNumber();
+    const int lastLine = m_document->findBlock(lastPosition).blockNumber();
+    m_firstVisibleLine = std::max(0, firstLine);
+    m_lastVisibleLine = 0 <= lastLine ? lastLine : m_document->blockCount() - 1;
+
+    m_highlighting = true;
+    m_editorHighlighter->setVisibleLines(m_firstVisibleLine, m_lastVisibleLine);
+    m_highlighting = false;
+
+    // The preview of a large note follows the sections shown in the editor
+    if (m_largeNote && m_renderEnabled && m_renderCount != 0
+        && (m_firstVisibleLine < m_renderedFirstLine || m_renderedLastLine < m_lastVisibleLine)) {
+        renderDoc();
     }
 }
 
@@ -345,7 +605,12 @@ void EditorHandler::editorFontChanged()
 void EditorHandler::addExtendedSyntax(const QStringList &details)
 {
     const auto opts = details[0].toInt();
-    m_renderer->addExtendedSyntax(opts, details[1], details[2]);
+    QMetaObject::invokeMethod(
+        m_renderWorker,
+        [worker = m_renderWorker, opts, openingHTML = details[1], closingHTML = details[2]]() {
+            worker->addExtendedSyntax(opts, openingHTML, closingHTML);
+        },
+        Qt::QueuedConnection);
     m_editorHighlighter->addExtendedSyntax(opts, details);
 }
 
@@ -417,9 +682,38 @@ QSharedPointer<MD::Document> EditorHandler::currentDoc() const
 // Parsing
 void EditorHandler::onParsingDone(QSharedPointer<MD::Document> mdDoc, unsigned long long int parseCount)
 {
-    if (parseCount == m_parseCount) {
-        m_currentMdDoc = mdDoc;
-        cacheAndHighlightSyntax(m_currentMdDoc);
+    editorTrace::instant("parsingDone", parseCount);
+    if (parseCount != m_parseCount) {
+        editorTrace::asyncEnd("edit", parseCount);
+        return;
+    }
+
+    // Superseded by a newer text, which can be parsed right away
+    if (!mdDoc) {
+        editorTrace::asyncEnd("edit", parseCount);
+        m_parseScheduler->parseCancelled();
+        return;
+    }
+
+    // The text changed since this parsing was requested, its positions are already outdated
+    if (!m_parseScheduler->hasPendingRequest()) {
+        documentRelease::releaseLater(std::exchange(m_currentMdDoc, mdDoc));
+        // Nothing is pending, the snapshot is still the parsed text
+        m_currentTextSnapshot = m_textSnapshot;
+        m_currentParseCount = parseCount;
+        {
+            const editorTrace::Span span("highlight", parseCount);
+            cacheAndHighlightSyntax(m_currentMdDoc);
+        }
+
+        // The delims were updated with the highlighting, the cursor move waiting for it is handled
+        if (m_delimsUpdatePending && m_currentParseCount == m_parseGeneration->load()) {
+            m_delimsUpdatePending = false;
+            m_textChanged = false;
+            if (!m_largeNote && !m_noteDir.isEmpty()) {
+                emitSurroundingDelimsTypes();
+            }
+        }
 
         if (m_noteFirstHighlight) {
             m_noteFirstHighlight = false;
@@ -428,8 +722,66 @@ void EditorHandler::onParsingDone(QSharedPointer<MD::Document> mdDoc, unsigned l
 
         if (m_renderEnabled) {
             renderDoc();
+        } else {
+            // Nothing to show, the edit ends with the highlighting
+            editorTrace::asyncEnd("edit", parseCount);
         }
+    } else {
+        editorTrace::asyncEnd("edit", parseCount);
+    }
+
+    m_parseScheduler->parseFinished(m_parseTimer.elapsed());
+}
+
+void EditorHandler::onRenderingDone(const QStringList &blockIds, const QStringList &blocks, unsigned long long int parseCount)
+{
+    if (parseCount == m_renderCount) {
+        editorTrace::handedToPreview(parseCount);
+        const editorTrace::Span span("webChannel", parseCount);
+        Q_EMIT renderingFinished(blockIds, blocks);
+    } else {
+        editorTrace::asyncEnd("edit", parseCount);
+    }
+}
+
+void EditorHandler::onParseRequested()
+{
+    if (m_document) {
+        parse(m_textSnapshot);
+    } else {
+        m_parseScheduler->parseFinished(0);
+    }
+}
+
+void EditorHandler::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+
+    // Formats changes don't touch the text
+    if (m_highlighting || !m_document) {
+        return;
+    }
+
+    const int blockCount = m_document->blockCount();
+    const int lastPosition = std::min(position + charsAdded, m_document->characterCount() - 1);
+
+    TextEdit edit;
+    edit.firstLine = m_document->findBlock(position).blockNumber();
+    edit.lineDelta = blockCount - m_blockCount;
+    edit.lastLine = m_document->findBlock(lastPosition).blockNumber() - edit.lineDelta;
+    if (edit.firstLine < 0 || edit.lastLine < edit.firstLine) {
+        edit = TextEdit::fullEdit();
     }
+
+    m_blockCount = blockCount;
+    updateLargeNote();
+    updateTextSnapshot(edit);
+    m_pendingEdit.merge(edit);
+    m_editorHighlighter->textEdited(edit);
+
+    // The pending lines are outdated, the highlighting will resume with the next parsing
+    m_highlightTimer->stop();
+    m_editorHighlighter->cancelPendingHighlight();
 }
 // !Parsing
 
@@ -444,25 +796,66 @@ void EditorHandler::renderPreviewStateChanged()
 void EditorHandler::codeHighlightEnabledChanged()
 {
     m_config->save();
-    m_renderer->setCodeHighlightEnable(KleverConfig::codeSynthaxHighlightEnabled());
+    QMetaObject::invokeMethod(
+        m_renderWorker,
+        [worker = m_renderWorker, enable = KleverConfig::codeSynthaxHighlightEnabled()]() {
+            worker->setCodeHighlightEnable(enable);
+        },
+        Qt::QueuedConnection);
 }
 
 void EditorHandler::newHighlightStyle()
 {
     m_config->save();
-    m_pluginHelper->highlightParserUtils()->newHighlightStyle();
+    QMetaObject::invokeMethod(
+        m_renderWorker,
+        [worker = m_renderWorker, highlighter = KleverConfig::codeSynthaxHighlighter(), style = KleverConfig::codeSynthaxHighlighterStyle()]() {
+            worker->newHighlightStyle(highlighter, style);
+        },
+        Qt::QueuedConnection);
+}
+
+void EditorHandler::noteMapEnabledChanged()
+{
+    // Saved by the application, the rendering thread only gets the value
+    QMetaObject::invokeMethod(
+        m_renderWorker,
+        [worker = m_renderWorker, enable = KleverConfig::noteMapEnabled()]() {
+            worker->setNoteMapEnable(enable);
+        },
+        Qt::QueuedConnection);
+}
+
+void EditorHandler::parserSettingsChanged()
+{
+    QMetaObject::invokeMethod(
+        m_renderWorker,
+        [worker = m_renderWorker, quickEmoji = KleverConfig::quickEmojiEnabled(), emojiTone = KleverConfig::emojiTone(), noteMap = KleverConfig::noteMapEnabled()]() {
+            worker->setParserSettings(quickEmoji, emojiTone, noteMap);
+        },
+        Qt::QueuedConnection);
 }
 
 void EditorHandler::pumlEnabledChanged()
 {
     m_config->save();
-    m_renderer->setPUMLenable(KleverConfig::pumlEnabled());
+    QMetaObject::invokeMethod(
+        m_renderWorker,
+        [worker = m_renderWorker, enable = KleverConfig::pumlEnabled()]() {
+            worker->setPUMLenable(enable);
+        },
+        Qt::QueuedConnection);
 }
 
 void EditorHandler::pumlDarkChanged()
 {
     m_config->save();
-    m_renderer->setPUMLdark(KleverConfig::pumlDark());
+    QMetaObject::invokeMethod(
+        m_renderWorker,
+        [worker = m_renderWorker, dark = KleverConfig::pumlDark()]() {
+            worker->setPUMLdark(dark);
+        },
+        Qt::QueuedConnection);
 }
 // !Plugins
 
@@ -487,24 +880,71 @@ void EditorHandler::tagScaleChanged()
     m_editorHighlighter->changeTagScale(m_config->tagSizeScale());
 }
 
+void EditorHandler::highlightSliceBudgetChanged()
+{
+    m_config->save();
+    m_editorHighlighter->setSliceBudget(m_config->highlightSliceBudget());
+}
+
 void EditorHandler::cursorMovedTimeOut()
 {
-    if (!m_textChanged) {
+    // The timer is shorter than the parsing debounce, the cached formats can point to blocks the edit removed
+    if (m_currentParseCount != m_parseGeneration->load()) {
+        m_delimsUpdatePending = true;
+        return;
+    }
+
+    if (!m_textChanged && !m_largeNote) {
         m_highlighting = true;
         m_surroundingDelims = m_editorHighlighter->showDelimAroundCursor(m_textChanged);
         m_highlighting = false;
 
-        QList<int> delimsTypes;
-        for (const auto &delimInfo : m_surroundingDelims) {
-            if (!delimsTypes.contains(delimInfo.delimType)) {
-                delimsTypes.append(delimInfo.delimType);
-            }
-        }
-        Q_EMIT surroundingDelimsChanged(delimsTypes);
+        emitSurroundingDelimsTypes();
     }
 
     m_textChanged = false;
 }
+
+void EditorHandler::emitSurroundingDelimsTypes()
+{
+    QList<int> delimsTypes;
+    for (const auto &delimInfo : m_surroundingDelims) {
+        if (!delimsTypes.contains(delimInfo.delimType)) {
+            delimsTypes.append(delimInfo.delimType);
+        }
+    }
+    Q_EMIT surroundingDelimsChanged(delimsTypes);
+}
+
+void EditorHandler::largeNoteThresholdChanged()
+{
+    m_config->save();
+    const bool wasLarge = m_largeNote;
+    updateLargeNote();
+
+    // Nothing was edited, the current document still matches the text
+    if (wasLarge != m_largeNote && m_currentMdDoc) {
+        cacheAndHighlightSyntax(m_currentMdDoc);
+        if (m_renderEnabled) {
+            renderDoc();
+        }
+    }
+}
+
+void EditorHandler::highlightTimeOut()
+{
+    if (!m_editorHighlighter->hasPendingHighlight()) {
+        return;
+    }
+
+    m_highlighting = true;
+    const bool finished = m_editorHighlighter->highlightNextSlice();
+    m_highlighting = false;
+
+    if (!finished) {
+        m_highlightTimer->start();
+    }
+}
 // !Highlight
 // !KleverNotes slots
 }
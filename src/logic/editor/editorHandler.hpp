@@ -9,13 +9,18 @@
 #include "colors.hpp"
 #include "kleverconfig.h"
 #include "logic/editor/posCacheUtils.hpp"
+#include "logic/parser/incrementalParser.h"
+#include "logic/parser/parseCancellation.h"
+#include "logic/parser/previewSections.h"
 #include "logic/parser/plugins/pluginHelper.h"
 #include "logic/parser/renderer.h"
+#include "logic/parser/textSnapshot.h"
 
 // md4qt include.
 #include <md4qt/src/doc.h>
 
 // Qt include
+#include <QElapsedTimer>
 #include <QObject>
 #include <QQuickTextDocument>
 #include <QTextDocument>
@@ -28,6 +33,8 @@ namespace MdEditor
 {
 
 class Parser;
+class ParseScheduler;
+class RenderWorker;
 class EditorHighlighter;
 /**
  * @class EditorHandler
@@ -46,6 +53,12 @@ class EditorHandler : public QObject
 
     Q_PROPERTY(QString notePath READ getNotePath WRITE setNotePath)
 
+    Q_PROPERTY(int parseBudget READ parseBudget NOTIFY parseBudgetChanged)
+    Q_PROPERTY(int droppedParseRequests READ droppedParseRequests NOTIFY droppedParseRequestsChanged)
+
+    Q_PROPERTY(bool largeNote READ largeNote NOTIFY largeNoteChanged)
+    Q_PROPERTY(bool loadingNote READ loadingNote NOTIFY loadingNoteChanged)
+
 public:
     explicit EditorHandler(QObject *parent = nullptr);
     ~EditorHandler();
@@ -103,11 +116,27 @@ public:
     void parseDoc();
 
     /**
-     * @brief Parse the given src.
+     * @brief Parse the given snapshot.
+     *
+     * @param snapshot The lines to be parsed.
+     */
+    void parse(const TextSnapshot &snapshot);
+
+    /**
+     * @brief Get the debounce window currently applied before parsing the note.
+     * Required by Q_PROPERTY
+     *
+     * @return The debounce window in milliseconds.
+     */
+    int parseBudget() const;
+
+    /**
+     * @brief Get the number of parsing requests coalesced into another one since the note was opened.
+     * Required by Q_PROPERTY
      *
-     * @param src The string to be parsed.
+     * @return The number of dropped parsing requests.
      */
-    void parse(const QString &src);
+    int droppedParseRequests() const;
 
     /**
      * @brief Get the current note path.
@@ -130,6 +159,42 @@ public:
      */
     Parser *parser() const;
 
+    // Large note
+    /**
+     * @brief Check if the note is edited in large note mode.
+     * In this mode only the visible lines are highlighted, the preview only shows the sections around them
+     * and the delims around the cursor are not revealed.
+     * Required by Q_PROPERTY
+     *
+     * @return True if the note is in large note mode, false otherwise.
+     */
+    bool largeNote() const;
+
+    /**
+     * @brief Check if a large note is still being loaded into the TextArea.
+     * Required by Q_PROPERTY
+     *
+     * @return True if some text is still to be loaded, false otherwise.
+     */
+    bool loadingNote() const;
+
+    /**
+     * @brief Start loading the text of a note into the TextArea.
+     * A large note is loaded by chunks, the rest is appended by `loadNextChunk`.
+     *
+     * @param text The text of the note.
+     * @return The text to put in the TextArea, the whole text if the note is not large.
+     */
+    Q_INVOKABLE QString startLoading(const QString &text);
+
+    /**
+     * @brief Append the next chunk of the note being loaded to the document.
+     * The chunks are not on the undo stack, it starts empty once the whole note is loaded and parsed.
+     *
+     * @return True if a chunk was appended, false once the whole note is loaded.
+     */
+    Q_INVOKABLE bool loadNextChunk();
+
     // md-editor
     /**
      * @brief Get the MD::Document resulting of the parsing.
@@ -144,6 +209,14 @@ public:
      */
     EditorHighlighter *editorHighlighter() const;
 
+    /**
+     * @brief Set the part of the note visible in the TextArea, it will be highlighted first.
+     *
+     * @param firstPosition The position of the first visible character.
+     * @param lastPosition The position of the last visible character.
+     */
+    Q_INVOKABLE void setVisibleArea(const int firstPosition, const int lastPosition);
+
     // Colors
     /**
      * @brief Change the current style based on the given information.
@@ -216,19 +289,50 @@ Q_SIGNALS:
     /**
      * @brief Signals that the editor wants to parse the given `md`.
      *
-     * @param md The text to be parsed.
+     * @param snapshot The lines of the text to be parsed.
      * @param notePath The current note path.
      * @param noteName The current note name.
+     * @param edit The lines touched since the previous request.
      * @param counter The current counter of parse.
      */
-    void askForParsing(const QString &md, const QString &notePath, const QString &noteName, unsigned long long int counter);
+    void askForParsing(const MdEditor::TextSnapshot &snapshot, const QString &notePath, const QString &noteName, const MdEditor::TextEdit &edit, unsigned long long int counter);
 
     /**
      * @brief Signals that the render has finished and the content is available.
      *
-     * @param content The rendered content (HTML).
+     * @param blockIds The id of each rendered block.
+     * @param blocks The HTML of each rendered block.
+     */
+    void renderingFinished(const QStringList &blockIds, const QStringList &blocks);
+
+    /**
+     * @brief Signals that the editor wants to render the given `mdDoc`.
+     *
+     * @param mdDoc The MD::Document to render.
+     * @param source The text the MD::Document was parsed from.
+     * @param counter The parsing number of the MD::Document.
      */
-    void renderingFinished(const QString &content);
+    void askForRendering(QSharedPointer<MD::Document> mdDoc, const MdEditor::TextSnapshot &source, unsigned long long int counter);
+
+    /**
+     * @brief Signals that the debounce window applied before parsing has changed.
+     */
+    void parseBudgetChanged();
+
+    /**
+     * @brief Signals that the number of dropped parsing requests has changed.
+     */
+    void droppedParseRequestsChanged();
+
+    /**
+     * @brief Emitted when the note enters or leaves the large note mode.
+     */
+    void largeNoteChanged();
+
+    /**
+     * @brief Emitted when a large note starts or finishes loading.
+     */
+    void loadingNoteChanged();
 
     // Toolbar
     /**
@@ -273,10 +377,22 @@ private Q_SLOTS:
     void codeHighlightEnabledChanged();
 
     /**
-     * @brief Receives the info that that code highlighting style has changed.
+     * @brief Receives the info that the code highlighter or its style has changed.
      */
     void newHighlightStyle();
 
+    // NoteMapper
+    /**
+     * @brief Receives the info that the NoteMapper plugin being enabled has changed.
+     */
+    void noteMapEnabledChanged();
+
+    // Parser
+    /**
+     * @brief Receives the info that a setting of the parser has changed, the rendered blocks depend on it.
+     */
+    void parserSettingsChanged();
+
     // PUML
     /**
      * @brief Receives the info that the PUML plugin being enabled has changed.
@@ -304,11 +420,26 @@ private Q_SLOTS:
      */
     void tagScaleChanged();
 
+    /**
+     * @brief Receives the info that the time spent highlighting between two events has changed.
+     */
+    void highlightSliceBudgetChanged();
+
+    /**
+     * @brief Slot to react to the change of the large note threshold.
+     */
+    void largeNoteThresholdChanged();
+
     /**
      * @brief Receives the info that timer tracking the cursor movement has timed out.
      */
     void cursorMovedTimeOut();
 
+    /**
+     * @brief Receives the info that the next slice of the highlighting can be done.
+     */
+    void highlightTimeOut();
+
     // Render
     /**
      * @brief Receives the info the preview being rendered has changed.
@@ -321,6 +452,29 @@ private Q_SLOTS:
      */
     void onParsingDone(QSharedPointer<MD::Document>, unsigned long long int);
 
+    /**
+     * @brief Receives the info that the scheduler wants the note to be parsed.
+     */
+    void onParseRequested();
+
+    /**
+     * @brief Receives the HTML produced by the render worker.
+     *
+     * @param blockIds The id of each rendered block.
+     * @param blocks The HTML of each rendered block.
+     * @param parseCount The parsing number of the rendered MD::Document, used to discard outdated renders.
+     */
+    void onRenderingDone(const QStringList &blockIds, const QStringList &blocks, unsigned long long int parseCount);
+
+    /**
+     * @brief Receives the info that the text of the document has changed, used to track the edited lines.
+     *
+     * @param position The position where the change happened.
+     * @param charsRemoved The number of removed characters.
+     * @param charsAdded The number of added characters.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
 private:
     // Parser
     /**
@@ -357,6 +511,11 @@ private:
      */
     void connectParser();
 
+    /**
+     * @brief Move the render worker to its thread and connect it to its different signals handler.
+     */
+    void connectRenderer();
+
     /**
      * @brief Connects the different plugins.
      */
@@ -402,12 +561,55 @@ private:
      */
     void setSelectionEnd(const int position);
 
+    // Parsing
+    /**
+     * @brief Get the parsing number that the next parsing will use.
+     *
+     * @return The next parsing number.
+     */
+    unsigned long long int nextParseCount() const;
+
+    /**
+     * @brief Apply an edit of the document to the text snapshot, only the edited lines are read.
+     *
+     * @param edit The lines touched by the edit.
+     */
+    void updateTextSnapshot(const TextEdit &edit);
+
     // Render
     /**
      * @brief Render the MD::Document resulting of the parsing.
+     * In large note mode, only the sections around the visible lines are rendered.
      */
     void renderDoc();
 
+    // Large note
+    /**
+     * @brief Enter or leave the large note mode based on the size of the document.
+     */
+    void updateLargeNote();
+
+    /**
+     * @brief Enter or leave the large note mode.
+     *
+     * @param largeNote Whether the note is in large note mode.
+     */
+    void setLargeNote(const bool largeNote);
+
+    /**
+     * @brief Set whether a large note is being loaded.
+     *
+     * @param loading Whether the note is being loaded.
+     */
+    void setLoadingNote(const bool loading);
+
+    /**
+     * @brief Get the next chunk of the loading text, cut at a line end.
+     *
+     * @return The next chunk.
+     */
+    QString loadingChunk();
+
     // ExtendedSyntax
     /**
      * @brief Add an extended syntax based on its details.
@@ -437,6 +639,11 @@ private:
      */
     void updateSurroundingDelims();
 
+    /**
+     * @brief Send the types of the delims surrounding the cursor, for the toolbar.
+     */
+    void emitSurroundingDelimsTypes();
+
 private:
     // Config Connections
     KleverConfig *m_config;
@@ -452,23 +659,48 @@ private:
     QString m_noteDir;
     QString m_noteName;
     Parser *m_parser = nullptr;
-    unsigned long long int m_parseCount;
+    unsigned long long int m_parseCount = 0;
+    // Parsing number of the newest text, an older parsing in flight is aborted
+    QSharedPointer<parseCancellation::Generation> m_parseGeneration = QSharedPointer<parseCancellation::Generation>::create(0);
     QThread *m_parsingThread = nullptr;
     QSharedPointer<MD::Document> m_currentMdDoc = nullptr;
+    // Text of the current document, the lines of its items point into it
+    TextSnapshot m_currentTextSnapshot;
+    unsigned long long int m_currentParseCount = 0;
+    ParseScheduler *m_parseScheduler = nullptr;
+    QElapsedTimer m_parseTimer;
+    TextEdit m_pendingEdit = TextEdit::fullEdit();
+    int m_blockCount = 0;
+    // Lines of the document, kept in sync on each edit
+    TextSnapshot m_textSnapshot;
 
     // Rendering
     bool m_renderEnabled = true;
-    Renderer *m_renderer = nullptr;
-
-    // Plugins
-    PluginHelper *m_pluginHelper = nullptr;
+    RenderWorker *m_renderWorker = nullptr;
+    QThread *m_renderingThread = nullptr;
+    unsigned long long int m_renderCount = 0; // Parsing number of the last requested render, 0 if none
+    // Lines covered by the rendered sections in large note mode
+    qsizetype m_renderedFirstLine = 0;
+    qsizetype m_renderedLastLine = -1;
+
+    // Large note
+    bool m_largeNote = false;
+    bool m_loadingNote = false;
+    // Text of the note being loaded, up to the loading position
+    QString m_loadingText;
+    qsizetype m_loadingPosition = 0;
 
     // Editor highlight
     EditorHighlighter *m_editorHighlighter = nullptr;
     QTimer *m_cursorMoveTimer = nullptr;
+    QTimer *m_highlightTimer = nullptr;
     bool m_highlighting = false; // Used as a switch to prevent the highlighting from retriggering the parsing
     bool m_noteFirstHighlight = true;
     bool m_textChanged = false;
+    // The cursor moved while the edit was not highlighted yet, its delims are shown once it is
+    bool m_delimsUpdatePending = false;
+    int m_firstVisibleLine = 0;
+    int m_lastVisibleLine = -1;
 
     // Toolbar
     QList<posCacheUtils::DelimsInfo> m_surroundingDelims;
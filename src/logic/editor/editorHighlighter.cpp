@@ -6,6 +6,7 @@
 // KleverNotes includes
 #include "logic/editor/editorHandler.hpp"
 #include "logic/editor/editorTextManipulation.hpp"
+#include "logic/parser/documentRelease.h"
 
 // Qt include.
 #include <QTextBlock>
@@ -13,9 +14,15 @@
 #include <QTextCursor>
 #include <QTextEdit>
 
+// C++ include
+#include <utility>
+
 using namespace Qt::Literals::StringLiterals;
 
 static const int USERDEFINEDINT = static_cast<int>(MD::ItemType::UserDefined);
+using Private = MdEditor::EditorHighlighterPrivate;
+// Lines highlighted right away around the visible ones
+static const int VISIBLE_MARGIN = 50;
 
 namespace MdEditor
 {
@@ -32,6 +39,7 @@ EditorHighlighter::~EditorHighlighter()
 void EditorHighlighter::setFont(const QFont &f)
 {
     d->font = f;
+    d->invalidateFormatTable();
 }
 
 void EditorHighlighter::clearHighlighting()
@@ -39,9 +47,15 @@ void EditorHighlighter::clearHighlighting()
     d->clearFormats();
 }
 
+void EditorHighlighter::textEdited(const TextEdit &edit)
+{
+    d->moveFormattedLines(edit);
+}
+
 void EditorHighlighter::setColors(const Colors &colors)
 {
     d->colors = colors;
+    d->invalidateFormatTable();
 }
 
 void EditorHighlighter::cacheAndHighlight(QSharedPointer<MD::Document> doc, const bool highlight)
@@ -49,23 +63,85 @@ void EditorHighlighter::cacheAndHighlight(QSharedPointer<MD::Document> doc, cons
     m_highlightEnabled = highlight;
     auto c = d->editor->textCursor();
     c.beginEditBlock();
-    d->clearFormats();
+    m_startProgressive = highlight && ((0 < m_sliceBudget && 0 <= m_lastVisibleLine) || m_visibleOnly);
+    if (highlight) {
+        // The new formats are diffed against the applied ones in `applyFormats`
+        d->resetFormats();
+    } else {
+        d->clearFormats();
+    }
 
-    d->doc = doc;
+    auto previousDoc = std::exchange(d->doc, doc);
 
     MD::PosCache::initialize(d->doc);
+    m_positionIndex.build(m_cache);
+    m_pairsCache.clear();
+    // Nothing points into the previous tree anymore
+    documentRelease::releaseLater(std::move(previousDoc));
     c.endEditBlock();
     showDelimAroundCursor();
 }
 
+void EditorHighlighter::setVisibleLines(const int firstLine, const int lastLine)
+{
+    m_firstVisibleLine = firstLine;
+    m_lastVisibleLine = lastLine;
+
+    // The newly visible lines jump ahead of the pending ones
+    if (d->hasPendingFormats()) {
+        QList<int> lines;
+        const auto end = d->formats.upperBound(lastLine + VISIBLE_MARGIN);
+        for (auto it = d->formats.lowerBound(firstLine - VISIBLE_MARGIN); it != end; ++it) {
+            lines.append(it.key());
+        }
+
+        auto c = d->editor->textCursor();
+        c.beginEditBlock();
+        d->applyLines(lines);
+        c.endEditBlock();
+    }
+}
+
+void EditorHighlighter::setSliceBudget(const int budget)
+{
+    m_sliceBudget = budget;
+}
+
+void EditorHighlighter::setVisibleOnly(const bool visibleOnly)
+{
+    m_visibleOnly = visibleOnly;
+}
+
+bool EditorHighlighter::hasPendingHighlight() const
+{
+    return d->hasPendingFormats();
+}
+
+bool EditorHighlighter::highlightNextSlice()
+{
+    auto c = d->editor->textCursor();
+    c.beginEditBlock();
+    const bool finished = d->applyPendingFormats(m_sliceBudget);
+    c.endEditBlock();
+
+    return finished;
+}
+
+void EditorHighlighter::cancelPendingHighlight()
+{
+    d->cancelPendingFormats();
+}
+
 void EditorHighlighter::addExtendedSyntax(const long long int opts, const QStringList &info)
 {
     d->modifications[opts] = info;
+    d->invalidateFormatTable();
 }
 
 void EditorHighlighter::changeAdaptiveTagSize(const bool adaptive)
 {
     d->adaptiveTagSize = adaptive;
+    d->invalidateFormatTable();
 }
 
 void EditorHighlighter::changeTagScale(const int tagSizeScale)
@@ -74,6 +150,7 @@ void EditorHighlighter::changeTagScale(const int tagSizeScale)
         return;
     }
     d->tagSizeScale = tagSizeScale;
+    d->invalidateFormatTable();
 }
 
 void EditorHighlighter::addBlockDelims(QList<posCacheUtils::DelimsInfo> &delims,
@@ -86,10 +163,10 @@ void EditorHighlighter::addBlockDelims(QList<posCacheUtils::DelimsInfo> &delims,
     const auto blockEnd = 1 < blockLen ? blockLen - 1 : blockLen;
     if (blockEnd) {
         const auto line = block.blockNumber();
-        Items blockItems = findFirstInCache({blockEnd, line, blockEnd, line});
+        const Items blockItems = m_positionIndex.itemsAt(line, blockEnd);
 
         if (!blockItems.isEmpty()) {
-            posCacheUtils::addDelimsFromItems(delims, blockItems, pos, selectStartPos, selectEndPos);
+            posCacheUtils::addDelimsFromItems(delims, m_pairsCache, blockItems, pos, selectStartPos, selectEndPos);
         }
     }
 }
@@ -110,6 +187,12 @@ QList<posCacheUtils::DelimsInfo> EditorHighlighter::getDelimsFromCursor()
     if (!block.contains(selectionEnd)) {
         block = block.next();
         while (block.isValid() && !block.contains(selectionEnd)) {
+            // Most of the lines of a large selection hold nothing
+            if (!m_positionIndex.hasItems(block.blockNumber())) {
+                block = block.next();
+                continue;
+            }
+
             const auto blockLen = editorTextManipulation::rstrip(block.text()).length();
             const auto blockEnd = 1 < blockLen ? blockLen - 1 : blockLen;
             const MD::WithPosition blockPos(blockEnd, block.blockNumber(), blockEnd, block.blockNumber());
@@ -130,6 +213,7 @@ QList<posCacheUtils::DelimsInfo> EditorHighlighter::getDelimsFromCursor()
     addBlockDelims(delims, startingBlock, startPos, startPos, endPos);
     addBlockDelims(delims, block, endPos, startPos, endPos);
 
+    posCacheUtils::removeDuplicates(delims);
     return delims;
 }
 
@@ -142,18 +226,35 @@ void EditorHighlighter::revertDelimsStyle(const QList<posCacheUtils::DelimsInfo>
 
 QList<posCacheUtils::DelimsInfo> EditorHighlighter::showDelimAroundCursor(const bool clearCache)
 {
+    // Lines whose formats are modified by the delims around the cursor
+    QList<int> touchedLines;
     if (clearCache) {
         d->cachedFormats.clear();
     } else {
+        touchedLines = d->cachedFormats.keys();
         d->restoreCachedFormats();
     }
 
-    const auto delims = getDelimsFromCursor();
+    // Looking for the delims of a large note on each cursor move costs more than it helps
+    const auto delims = m_visibleOnly ? QList<posCacheUtils::DelimsInfo>() : getDelimsFromCursor();
     if (m_highlightEnabled) {
         auto c = d->editor->textCursor();
         c.joinPreviousEditBlock();
         revertDelimsStyle(delims);
-        d->applyFormats();
+        touchedLines.append(d->cachedFormats.keys());
+
+        if (m_startProgressive) {
+            m_startProgressive = false;
+            const int cursorLine = c.blockNumber();
+            d->startProgressiveApply(m_firstVisibleLine - VISIBLE_MARGIN, m_lastVisibleLine + VISIBLE_MARGIN, cursorLine);
+            d->applyLines(touchedLines);
+        } else if (!clearCache || d->hasPendingFormats()) {
+            // The other lines are untouched since the last apply or will be applied later
+            d->applyLines(touchedLines);
+        } else {
+            d->applyFormats();
+        }
+
         d->preventAutoScroll();
         c.endEditBlock();
     }
@@ -163,7 +264,7 @@ QList<posCacheUtils::DelimsInfo> EditorHighlighter::showDelimAroundCursor(const
 
 MD::ListItem *EditorHighlighter::searchListItem(const int line, const int pos)
 {
-    const Items blockItems = findFirstInCache({pos, line, pos, line});
+    const Items blockItems = m_positionIndex.itemsAt(line, pos);
 
     for (int i = blockItems.size() - 1; -1 != i; --i) {
         const auto item = blockItems.at(i);
@@ -178,9 +279,7 @@ MD::ListItem *EditorHighlighter::searchListItem(const int line, const int pos)
 void EditorHighlighter::onItemWithOpts(MD::ItemWithOpts *i)
 {
     if (m_highlightEnabled) {
-        QTextCharFormat special;
-        special.setForeground(d->colors.specialColor);
-        special.setFont(d->styleFont(d->additionalStyle, true));
+        const int special = d->formatId(Private::SpecialColor, d->additionalStyle, true);
 
         for (const auto &s : i->openStyles())
             d->setFormat(special, s);
@@ -193,8 +292,7 @@ void EditorHighlighter::onItemWithOpts(MD::ItemWithOpts *i)
 void EditorHighlighter::onText(MD::Text *t)
 {
     if (m_highlightEnabled) {
-        QTextCharFormat format = d->makeFormat(t->opts());
-        d->setFormat(format, t->startLine(), t->startColumn(), t->endLine(), t->endColumn());
+        d->setFormat(d->textFormatId(t->opts()), t->startLine(), t->startColumn(), t->endLine(), t->endColumn());
     }
     onItemWithOpts(t);
 
@@ -204,15 +302,10 @@ void EditorHighlighter::onText(MD::Text *t)
 void EditorHighlighter::onMath(MD::Math *m)
 {
     if (m_highlightEnabled) {
-        QTextCharFormat format;
-        format.setForeground(d->colors.mathColor);
-        format.setFont(d->styleFont(d->additionalStyle));
-
+        const int format = d->formatId(Private::MathColor, d->additionalStyle);
         d->setFormat(format, m->startLine(), m->startColumn(), m->endLine(), m->endColumn());
 
-        QTextCharFormat special;
-        special.setForeground(d->colors.specialColor);
-        special.setFont(d->styleFont(d->additionalStyle, true));
+        const int special = d->formatId(Private::SpecialColor, d->additionalStyle, true);
 
         if (m->startDelim().startColumn() != -1)
             d->setFormat(special, m->startDelim());
@@ -236,9 +329,7 @@ void EditorHighlighter::onHeading(MD::Heading *h)
         d->headingLevel = h->level();
         d->additionalStyle = d->additionalStyle | MD::BoldText;
 
-        QTextCharFormat baseFormat;
-        baseFormat.setForeground(d->colors.titleColor);
-        baseFormat.setFont(d->styleFont(MD::BoldText));
+        const int baseFormat = d->formatId(Private::TitleColor, MD::BoldText);
         const long long int formatStart = 0 <= h->text()->startColumn() ? h->text()->startColumn() : h->startColumn();
         d->setFormat(baseFormat, h->startLine(), formatStart, h->endLine(), h->endColumn());
     }
@@ -248,9 +339,7 @@ void EditorHighlighter::onHeading(MD::Heading *h)
     d->additionalStyle = inititalAdditionalStyle;
 
     if (m_highlightEnabled) {
-        QTextCharFormat special;
-        special.setForeground(d->colors.specialColor);
-        special.setFont(d->styleFont(MD::TextWithoutFormat, true));
+        const int special = d->formatId(Private::SpecialColor, MD::TextWithoutFormat, true);
 
         if (!h->delims().empty()) {
             for (const auto &delim : h->delims())
@@ -268,24 +357,14 @@ void EditorHighlighter::onHeading(MD::Heading *h)
 void EditorHighlighter::onCode(MD::Code *c)
 {
     if (m_highlightEnabled) {
-        QTextCharFormat format;
-        QTextCharFormat special;
-        format.setBackground(d->colors.codeBgColor);
-        format.setFont(d->styleFont(d->additionalStyle));
-
-        QColor foregroundColor = d->colors.codeColor;
-        if (c->opts() & 8) {
-            special.setBackground(d->colors.highlightColor);
-            foregroundColor = d->colors.highlightColor;
-        }
-        format.setForeground(foregroundColor);
+        const bool highlighted = c->opts() & 8;
 
+        const int format = d->formatId(highlighted ? Private::HighlightColor : Private::CodeColor, d->additionalStyle, false, Private::CodeBgColor);
         if (c->startColumn() != c->endColumn() || c->startLine() != c->endLine()) {
             d->setFormat(format, c->startLine(), c->startColumn(), c->endLine(), c->endColumn());
         }
 
-        special.setForeground(d->colors.specialColor);
-        special.setFont(d->styleFont(d->additionalStyle, true));
+        const int special = d->formatId(Private::SpecialColor, d->additionalStyle, true, highlighted ? Private::HighlightColor : Private::NoColor);
 
         if (c->startDelim().startColumn() != -1)
             d->setFormat(special, c->startDelim());
@@ -293,11 +372,8 @@ void EditorHighlighter::onCode(MD::Code *c)
         if (c->endDelim().startColumn() != -1)
             d->setFormat(special, c->endDelim());
 
-        QTextCharFormat syntax;
-        syntax.setForeground(d->colors.highlightColor);
-        syntax.setFont(d->styleFont(d->additionalStyle));
         if (c->syntaxPos().startColumn() != -1)
-            d->setFormat(syntax, c->syntaxPos());
+            d->setFormat(d->formatId(Private::HighlightColor, d->additionalStyle), c->syntaxPos());
     }
     onItemWithOpts(c);
 
@@ -307,22 +383,12 @@ void EditorHighlighter::onCode(MD::Code *c)
 void EditorHighlighter::onInlineCode(MD::Code *c)
 {
     if (m_highlightEnabled) {
-        QTextCharFormat format;
-        QTextCharFormat special;
-        format.setBackground(d->colors.codeBgColor);
-        format.setFont(d->styleFont(d->additionalStyle));
-
-        QColor foregroundColor = d->colors.codeColor;
-        if (c->opts() & 8) {
-            special.setBackground(d->colors.highlightColor);
-            foregroundColor = d->colors.highlightColor;
-        }
-        format.setForeground(foregroundColor);
+        const bool highlighted = c->opts() & 8;
 
+        const int format = d->formatId(highlighted ? Private::HighlightColor : Private::CodeColor, d->additionalStyle, false, Private::CodeBgColor);
         d->setFormat(format, c->startLine(), c->startColumn(), c->endLine(), c->endColumn());
 
-        special.setForeground(d->colors.specialColor);
-        special.setFont(d->styleFont(d->additionalStyle, true));
+        const int special = d->formatId(Private::SpecialColor, d->additionalStyle, true, highlighted ? Private::HighlightColor : Private::NoColor);
 
         if (c->startDelim().startColumn() != -1)
             d->setFormat(special, c->startDelim());
@@ -339,9 +405,7 @@ void EditorHighlighter::onBlockquote(MD::Blockquote *b)
 {
     MD::PosCache::onBlockquote(b);
     if (m_highlightEnabled) {
-        QTextCharFormat special;
-        special.setForeground(d->colors.linkColor);
-        special.setFont(d->styleFont(d->additionalStyle));
+        const int special = d->formatId(Private::LinkColor, d->additionalStyle);
 
         for (const auto &dd : b->delims())
             d->setFormat(special, dd);
@@ -352,9 +416,7 @@ void EditorHighlighter::onListItem(MD::ListItem *l, bool first, bool skipOpening
 {
     MD::PosCache::onListItem(l, first, skipOpeningWrap);
     if (m_highlightEnabled) {
-        QTextCharFormat special;
-        special.setForeground(d->colors.highlightColor);
-        special.setFont(d->styleFont(d->additionalStyle));
+        const int special = d->formatId(Private::HighlightColor, d->additionalStyle);
 
         d->setFormat(special, l->delim());
 
@@ -366,10 +428,7 @@ void EditorHighlighter::onListItem(MD::ListItem *l, bool first, bool skipOpening
 void EditorHighlighter::onTable(MD::Table *t)
 {
     if (m_highlightEnabled) {
-        QTextCharFormat format;
-        format.setForeground(d->colors.highlightColor);
-        format.setFont(d->styleFont(d->additionalStyle));
-
+        const int format = d->formatId(Private::HighlightColor, d->additionalStyle);
         d->setFormat(format, t->startLine(), t->startColumn(), t->endLine(), t->endColumn());
     }
     MD::PosCache::onTable(t);
@@ -378,10 +437,7 @@ void EditorHighlighter::onTable(MD::Table *t)
 void EditorHighlighter::onRawHtml(MD::RawHtml *h)
 {
     if (m_highlightEnabled) {
-        QTextCharFormat format;
-        format.setForeground(d->colors.highlightColor);
-        format.setFont(d->styleFont(d->additionalStyle));
-
+        const int format = d->formatId(Private::HighlightColor, d->additionalStyle);
         d->setFormat(format, h->startLine(), h->startColumn(), h->endLine(), h->endColumn());
     }
     onItemWithOpts(h);
@@ -392,10 +448,7 @@ void EditorHighlighter::onRawHtml(MD::RawHtml *h)
 void EditorHighlighter::onHorizontalLine(MD::HorizontalLine *l)
 {
     if (m_highlightEnabled) {
-        QTextCharFormat special;
-        special.setForeground(d->colors.linkColor);
-        special.setFont(d->styleFont(d->additionalStyle));
-
+        const int special = d->formatId(Private::LinkColor, d->additionalStyle);
         d->setFormat(special, l->startLine(), l->startColumn(), l->endLine(), l->endColumn());
     }
     MD::PosCache::onHorizontalLine(l);
@@ -405,25 +458,16 @@ void EditorHighlighter::onLink(MD::Link *l)
 {
     const int inititalAdditionalStyle = d->additionalStyle;
     if (m_highlightEnabled) {
-        QTextCharFormat generalFormat;
-        generalFormat.setForeground(d->colors.specialColor);
-        generalFormat.setFont(d->styleFont(l->opts() | d->additionalStyle));
-
+        const int generalFormat = d->formatId(Private::SpecialColor, l->opts() | d->additionalStyle);
         d->setFormat(generalFormat, l->startLine(), l->startColumn(), l->endLine(), l->endColumn());
 
         d->additionalStyle = d->additionalStyle | l->opts();
 
         if (!l->textPos().isNullPositions()) {
-            QTextCharFormat textFormat;
-            textFormat.setForeground(d->colors.textColor);
-            textFormat.setFont(d->styleFont(l->opts() | d->additionalStyle));
-            d->setFormat(textFormat, l->textPos());
+            d->setFormat(d->formatId(Private::TextColor, l->opts() | d->additionalStyle), l->textPos());
         }
 
-        QTextCharFormat urlFormat;
-        urlFormat.setForeground(d->colors.linkColor);
-        urlFormat.setFont(d->styleFont(l->opts() | d->additionalStyle));
-        urlFormat.setFontUnderline(true);
+        const int urlFormat = d->formatId(Private::LinkColor, l->opts() | d->additionalStyle, false, Private::NoColor, true);
         d->setFormat(urlFormat, l->urlPos());
     }
     MD::PosCache::onLink(l);
@@ -436,16 +480,10 @@ void EditorHighlighter::onLink(MD::Link *l)
 void EditorHighlighter::onReferenceLink(MD::Link *l)
 {
     if (m_highlightEnabled) {
-        QTextCharFormat generalFormat;
-        generalFormat.setForeground(d->colors.specialColor);
-        generalFormat.setFont(d->styleFont(d->additionalStyle));
-
+        const int generalFormat = d->formatId(Private::SpecialColor, d->additionalStyle);
         d->setFormat(generalFormat, l->startLine(), l->startColumn(), l->endLine(), l->endColumn());
 
-        QTextCharFormat urlFormat;
-        urlFormat.setForeground(d->colors.linkColor);
-        urlFormat.setFont(d->styleFont(d->additionalStyle));
-        urlFormat.setFontUnderline(true);
+        const int urlFormat = d->formatId(Private::LinkColor, d->additionalStyle, false, Private::NoColor, true);
         d->setFormat(urlFormat, l->urlPos());
     }
     MD::PosCache::onReferenceLink(l);
@@ -454,22 +492,13 @@ void EditorHighlighter::onReferenceLink(MD::Link *l)
 void EditorHighlighter::onImage(MD::Image *i)
 {
     if (m_highlightEnabled) {
-        QTextCharFormat generalFormat;
-        generalFormat.setForeground(d->colors.specialColor);
-        generalFormat.setFont(d->styleFont(d->additionalStyle));
-
+        const int generalFormat = d->formatId(Private::SpecialColor, d->additionalStyle);
         d->setFormat(generalFormat, i->startLine(), i->startColumn(), i->endLine(), i->endColumn());
 
-        QTextCharFormat urlFormat;
-        urlFormat.setForeground(d->colors.linkColor);
-        urlFormat.setFont(d->styleFont(d->additionalStyle));
-        urlFormat.setFontUnderline(true);
+        const int urlFormat = d->formatId(Private::LinkColor, d->additionalStyle, false, Private::NoColor, true);
         d->setFormat(urlFormat, i->urlPos());
 
-        QTextCharFormat textFormat;
-        textFormat.setForeground(d->colors.highlightColor);
-        textFormat.setFont(d->styleFont(d->additionalStyle));
-        d->setFormat(textFormat, i->textPos());
+        d->setFormat(d->formatId(Private::HighlightColor, d->additionalStyle), i->textPos());
     }
     MD::PosCache::onImage(i);
 
@@ -479,19 +508,10 @@ void EditorHighlighter::onImage(MD::Image *i)
 void EditorHighlighter::onFootnoteRef(MD::FootnoteRef *ref)
 {
     if (m_highlightEnabled) {
-        if (d->doc->footnotesMap().find(ref->id()) != d->doc->footnotesMap().cend()) {
-            QTextCharFormat format;
-            format.setForeground(d->colors.linkColor);
-            format.setFont(d->styleFont(ref->opts() | d->additionalStyle));
+        const bool known = d->doc->footnotesMap().find(ref->id()) != d->doc->footnotesMap().cend();
+        const int format = d->formatId(known ? Private::LinkColor : Private::TextColor, ref->opts() | d->additionalStyle);
 
-            d->setFormat(format, ref->startLine(), ref->startColumn(), ref->endLine(), ref->endColumn());
-        } else {
-            QTextCharFormat format;
-            format.setForeground(d->colors.textColor);
-            format.setFont(d->styleFont(ref->opts() | d->additionalStyle));
-
-            d->setFormat(format, ref->startLine(), ref->startColumn(), ref->endLine(), ref->endColumn());
-        }
+        d->setFormat(format, ref->startLine(), ref->startColumn(), ref->endLine(), ref->endColumn());
     }
     MD::PosCache::onFootnoteRef(ref);
 
@@ -501,10 +521,7 @@ void EditorHighlighter::onFootnoteRef(MD::FootnoteRef *ref)
 void EditorHighlighter::onFootnote(MD::Footnote *f)
 {
     if (m_highlightEnabled) {
-        QTextCharFormat format;
-        format.setForeground(d->colors.linkColor);
-        format.setFont(d->styleFont(d->additionalStyle));
-
+        const int format = d->formatId(Private::LinkColor, d->additionalStyle);
         d->setFormat(format, f->startLine(), f->startColumn(), f->endLine(), f->endColumn());
     }
     MD::PosCache::onFootnote(f);
@@ -514,24 +531,14 @@ void EditorHighlighter::onEmoji(EmojiPlugin::EmojiItem *e)
 {
     const int inititalAdditionalStyle = d->additionalStyle;
     if (m_highlightEnabled) {
-        QTextCharFormat generalFormat;
-        generalFormat.setForeground(d->colors.specialColor);
-        generalFormat.setFont(d->styleFont(e->opts() | d->additionalStyle, true));
-
+        const int generalFormat = d->formatId(Private::SpecialColor, e->opts() | d->additionalStyle, true);
         d->setFormat(generalFormat, e->startLine(), e->startColumn(), e->endLine(), e->endColumn());
 
         d->additionalStyle = d->additionalStyle | e->opts();
 
-        QTextCharFormat emojiFormat;
-        emojiFormat.setForeground(d->colors.linkColor);
-        emojiFormat.setFont(d->styleFont(e->opts() | d->additionalStyle));
-        d->setFormat(emojiFormat, e->emojiNamePos());
-
-        QTextCharFormat optionsFormat;
-        optionsFormat.setForeground(d->colors.highlightColor);
-        optionsFormat.setFont(d->styleFont(e->opts() | d->additionalStyle));
+        d->setFormat(d->formatId(Private::LinkColor, e->opts() | d->additionalStyle), e->emojiNamePos());
 
-        d->setFormat(optionsFormat, e->optionsPos());
+        d->setFormat(d->formatId(Private::HighlightColor, e->opts() | d->additionalStyle), e->optionsPos());
     }
     onItemWithOpts(e);
 
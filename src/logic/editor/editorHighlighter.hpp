@@ -7,6 +7,7 @@
 #include "editorHighlighterPrivate.hpp"
 #include "logic/editor/colors.hpp"
 #include "logic/editor/posCacheUtils.hpp"
+#include "logic/editor/positionIndex.hpp"
 #include "logic/parser/plugins/emoji/emojiPlugin.hpp"
 
 // md4qt include.
@@ -56,6 +57,56 @@ public:
      */
     void clearHighlighting();
 
+    /**
+     * @brief Set the lines currently visible in the editor, they are highlighted first.
+     *
+     * @param firstLine The first visible line.
+     * @param lastLine The last visible line.
+     */
+    void setVisibleLines(const int firstLine, const int lastLine);
+
+    /**
+     * @brief Set the time spent highlighting between two events of the event loop.
+     * A budget of 0 highlights the whole note at once.
+     *
+     * @param budget The time budget in milliseconds.
+     */
+    void setSliceBudget(const int budget);
+
+    /**
+     * @brief Restrict the highlighting to the visible lines, used for large notes.
+     * The other lines are highlighted once they become visible and the delims around the cursor are left as is.
+     *
+     * @param visibleOnly Whether only the visible lines are highlighted.
+     */
+    void setVisibleOnly(const bool visibleOnly);
+
+    /**
+     * @brief Check if some lines are still waiting to be highlighted.
+     *
+     * @return True if some lines are pending, false otherwise.
+     */
+    bool hasPendingHighlight() const;
+
+    /**
+     * @brief Highlight the next pending lines, within the slice budget.
+     *
+     * @return True if the whole note is now highlighted, false otherwise.
+     */
+    bool highlightNextSlice();
+
+    /**
+     * @brief Drop the lines waiting to be highlighted, used when the text changes.
+     */
+    void cancelPendingHighlight();
+
+    /**
+     * @brief Inform the highlighter that the text has been edited, used to track the highlighted lines.
+     *
+     * @param edit The lines touched by the edit.
+     */
+    void textEdited(const TextEdit &edit);
+
     /**
      * @brief Set the colors to be used for the highlighter.
      *
@@ -135,6 +186,18 @@ private:
 
     bool m_highlightEnabled = false;
 
+    // Line index of the positions cache, rebuilt with each parsing
+    PositionIndex m_positionIndex;
+    // Open/close delims pairs, filled while the cursor moves and cleared with each parsing
+    posCacheUtils::PairsCache m_pairsCache;
+
+    // Progressive highlighting
+    int m_firstVisibleLine = 0;
+    int m_lastVisibleLine = -1;
+    int m_sliceBudget = 0;
+    bool m_startProgressive = false;
+    bool m_visibleOnly = false;
+
     QScopedPointer<EditorHighlighterPrivate> d;
 }; // !EditorHighlighter
 } // !namespace MdEditor
@@ -7,8 +7,13 @@
 // md4qt include
 #include <md4qt/src/doc.h>
 
+// Qt include
+#include <QElapsedTimer>
+
 // C++ include
 #include <algorithm>
+#include <cstdlib>
+#include <iterator>
 #include <utility>
 
 using namespace Qt::Literals::StringLiterals;
@@ -22,65 +27,437 @@ EditorHighlighterPrivate::EditorHighlighterPrivate(EditorHandler *e)
 
 void EditorHighlighterPrivate::clearFormats()
 {
-    auto b = editor->document()->firstBlock();
-
-    while (b.isValid()) {
-        b.layout()->clearFormats();
+    resetFormats();
+    clearStaleFormats();
+    flushDirtyRanges();
 
-        b = b.next();
-    }
+    formattedLines.clear();
+}
 
+void EditorHighlighterPrivate::resetFormats()
+{
     formats.clear();
     cachedFormats.clear();
+    cancelPendingFormats();
+
+    // No run uses the outdated formats anymore
+    if (staleFormatTable) {
+        formatTable = {QTextCharFormat()};
+        staleFormatTable = false;
+    }
 }
 
 void EditorHighlighterPrivate::applyFormats()
 {
+    cancelPendingFormats();
+
     for (const auto &f : std::as_const(formats)) {
         currentBlock = f.block;
-        formatChanges = f.formats;
+        runChanges = f.runs;
+
+        applyFormatChanges();
+    }
+
+    clearStaleFormats();
+    flushDirtyRanges();
+
+    formattedLines = formats.keys();
+}
+
+void EditorHighlighterPrivate::startProgressiveApply(const int firstLine, const int lastLine, const int cursorLine)
+{
+    cancelPendingFormats();
+
+    QList<int> appliedLines;
+    for (auto it = formats.cbegin(); it != formats.cend(); ++it) {
+        const int line = it.key();
+        if (firstLine <= line && line <= lastLine) {
+            applyLine(line);
+            appliedLines.append(line);
+        } else {
+            pendingLines.append(line);
+        }
+    }
+
+    if (pendingLines.isEmpty()) {
+        clearStaleFormats();
+        flushDirtyRanges();
+        formattedLines = formats.keys();
+        return;
+    }
+
+    clearStaleFormats(firstLine, lastLine);
+    flushDirtyRanges();
+    addFormattedLines(appliedLines);
+
+    std::stable_sort(pendingLines.begin(), pendingLines.end(), [cursorLine](const int line1, const int line2) {
+        return std::abs(line1 - cursorLine) < std::abs(line2 - cursorLine);
+    });
+}
+
+bool EditorHighlighterPrivate::applyPendingFormats(const int budget)
+{
+    if (!hasPendingFormats()) {
+        return true;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const qsizetype sliceStart = pendingIndex;
+    // Checking the clock is not free, do it every few lines
+    static constexpr qsizetype linesPerCheck = 16;
+    while (pendingIndex < pendingLines.size()) {
+        applyLine(pendingLines.at(pendingIndex));
+        ++pendingIndex;
+
+        if (pendingIndex % linesPerCheck == 0 && budget <= timer.elapsed()) {
+            break;
+        }
+    }
+
+    addFormattedLines(pendingLines.mid(sliceStart, pendingIndex - sliceStart));
+
+    if (pendingIndex < pendingLines.size()) {
+        flushDirtyRanges();
+        return false;
+    }
+
+    cancelPendingFormats();
+    clearStaleFormats();
+    flushDirtyRanges();
+    formattedLines = formats.keys();
+    return true;
+}
+
+bool EditorHighlighterPrivate::hasPendingFormats() const
+{
+    return pendingIndex < pendingLines.size();
+}
+
+void EditorHighlighterPrivate::cancelPendingFormats()
+{
+    pendingLines.clear();
+    pendingIndex = 0;
+}
+
+void EditorHighlighterPrivate::applyLines(const QList<int> &lines)
+{
+    for (const int line : lines) {
+        applyLine(line);
+    }
+    addFormattedLines(lines);
+    flushDirtyRanges();
+}
+
+void EditorHighlighterPrivate::applyLine(const int line)
+{
+    const auto it = formats.constFind(line);
+    if (it != formats.cend()) {
+        currentBlock = it->block;
+        runChanges = it->runs;
 
         applyFormatChanges();
     }
 }
 
-void EditorHighlighterPrivate::setFormat(const QTextCharFormat &format, const MD::WithPosition &pos)
+void EditorHighlighterPrivate::clearStaleFormats(const int firstLine, const int lastLine)
+{
+    const auto document = editor->document();
+
+    // Those lines were highlighted before but have nothing to highlight anymore
+    if (checkAllLines) {
+        auto block = document->findBlockByNumber(firstLine);
+        for (; block.isValid() && block.blockNumber() <= lastLine; block = block.next()) {
+            if (!formats.contains(block.blockNumber())) {
+                clearBlockFormats(block);
+            }
+        }
+        // Only a full pass makes the formatted lines known again
+        checkAllLines = 0 < firstLine || block.isValid();
+        return;
+    }
+
+    const int blockCount = document->blockCount();
+    const auto begin = std::lower_bound(formattedLines.cbegin(), formattedLines.cend(), firstLine);
+    for (auto it = begin; it != formattedLines.cend() && *it <= lastLine; ++it) {
+        if (*it < blockCount && !formats.contains(*it)) {
+            clearBlockFormats(document->findBlockByNumber(*it));
+        }
+    }
+}
+
+void EditorHighlighterPrivate::addFormattedLines(QList<int> lines)
+{
+    if (lines.isEmpty()) {
+        return;
+    }
+
+    std::sort(lines.begin(), lines.end());
+
+    QList<int> mergedLines;
+    mergedLines.reserve(formattedLines.size() + lines.size());
+    std::set_union(formattedLines.cbegin(), formattedLines.cend(), lines.cbegin(), lines.cend(), std::back_inserter(mergedLines));
+    formattedLines = mergedLines;
+}
+
+void EditorHighlighterPrivate::moveFormattedLines(const TextEdit &edit)
+{
+    if (edit.isEmpty()) {
+        return;
+    }
+
+    if (edit.full) {
+        checkAllLines = true;
+        return;
+    }
+
+    // Kept sorted: the lines before the edit, the edited lines, then the moved lines after the edit
+    QList<int> movedLines;
+    movedLines.reserve(formattedLines.size());
+    auto it = formattedLines.cbegin();
+    for (; it != formattedLines.cend() && *it < edit.firstLine; ++it) {
+        movedLines.append(*it);
+    }
+
+    // The edited lines may hold the formats of merged or removed lines
+    for (qsizetype line = edit.firstLine; line <= edit.lastLine + edit.lineDelta; ++line) {
+        movedLines.append(line);
+    }
+
+    for (; it != formattedLines.cend(); ++it) {
+        if (edit.lastLine < *it) {
+            movedLines.append(*it + edit.lineDelta);
+        }
+    }
+
+    formattedLines = movedLines;
+}
+
+void EditorHighlighterPrivate::clearBlockFormats(const QTextBlock &block)
+{
+    if (!block.isValid()) {
+        return;
+    }
+
+    QTextLayout *layout = block.layout();
+    if (!layout->formats().isEmpty()) {
+        layout->clearFormats();
+        addDirtyRange(block.position(), block.length());
+    }
+}
+
+void EditorHighlighterPrivate::addDirtyRange(const int position, const int length)
+{
+    dirtyRanges.append({position, length});
+}
+
+void EditorHighlighterPrivate::flushDirtyRanges()
+{
+    if (dirtyRanges.isEmpty()) {
+        return;
+    }
+
+    std::sort(dirtyRanges.begin(), dirtyRanges.end());
+
+    int start = dirtyRanges.constFirst().first;
+    int end = start + dirtyRanges.constFirst().second;
+    for (const auto &[position, length] : std::as_const(dirtyRanges)) {
+        if (end < position) {
+            editor->document()->markContentsDirty(start, end - start);
+            start = position;
+        }
+        end = std::max(end, position + length);
+    }
+    editor->document()->markContentsDirty(start, end - start);
+
+    dirtyRanges.clear();
+}
+
+void EditorHighlighterPrivate::setFormat(const int formatId, const MD::WithPosition &pos)
 {
-    setFormat(format, pos.startLine(), pos.startColumn(), pos.endLine(), pos.endColumn());
+    setFormat(formatId, pos.startLine(), pos.startColumn(), pos.endLine(), pos.endColumn());
 }
 
-void EditorHighlighterPrivate::setFormat(const QTextCharFormat &format,
-                                         long long int startLine,
-                                         long long int startColumn,
-                                         long long int endLine,
-                                         long long int endColumn)
+void EditorHighlighterPrivate::setFormat(const int formatId, long long int startLine, long long int startColumn, long long int endLine, long long int endColumn)
 {
     if (colors.enabled) {
         for (auto i = startLine; i <= endLine; ++i) {
-            formats[i].block = editor->document()->findBlockByNumber(i);
+            auto &t = lineFormat(i);
+            const int lineLength = t.block.length() - 1;
 
-            if (formats[i].formats.isEmpty())
-                formats[i].formats.fill(QTextCharFormat(), formats[i].block.length() - 1);
+            const int start = i == startLine ? startColumn : 0;
+            const int end = i == endLine ? std::min(static_cast<int>(endColumn) + 1, lineLength) : lineLength;
 
-            int start = (i == startLine ? startColumn : 0);
-            int length = (i == startLine ? (i == endLine ? endColumn - startColumn + 1 : formats[i].block.length() - 1 - startColumn)
-                                         : (i == endLine ? endColumn + 1 : formats[i].block.length() - 1));
+            paintRun(t.runs, start, end, formatId);
+        }
+    }
+}
 
-            auto &t = formats[i];
-            for (int j = start; j < std::min((start + length), static_cast<int>(t.formats.length())); ++j) {
-                t.formats[j] = format;
-            }
+int EditorHighlighterPrivate::formatId(const ColorRole foreground,
+                                       const long long int opts,
+                                       const bool isSpecial,
+                                       const ColorRole background,
+                                       const bool underline)
+{
+    const FormatKey key{opts, headingLevel, foreground, background, isSpecial, underline, false};
+
+    const auto it = formatIds.constFind(key);
+    if (it != formatIds.cend()) {
+        return it.value();
+    }
+
+    QTextCharFormat format;
+    if (foreground != NoColor) {
+        format.setForeground(roleColor(foreground));
+    }
+    if (background != NoColor) {
+        format.setBackground(roleColor(background));
+    }
+    format.setFont(styleFont(opts, isSpecial));
+    if (underline) {
+        format.setFontUnderline(true);
+    }
+
+    const int id = internFormat(format);
+    formatIds.insert(key, id);
+    return id;
+}
+
+int EditorHighlighterPrivate::textFormatId(const long long int opts)
+{
+    FormatKey key;
+    key.opts = opts;
+    key.headingLevel = headingLevel;
+    key.isText = true;
+
+    const auto it = formatIds.constFind(key);
+    if (it != formatIds.cend()) {
+        return it.value();
+    }
+
+    const int id = internFormat(makeFormat(opts));
+    formatIds.insert(key, id);
+    return id;
+}
+
+void EditorHighlighterPrivate::invalidateFormatTable()
+{
+    formatIds.clear();
+    fonts.clear();
+    staleFormatTable = true;
+}
+
+QColor EditorHighlighterPrivate::roleColor(const ColorRole role) const
+{
+    switch (role) {
+    case TextColor:
+        return colors.textColor;
+    case TitleColor:
+        return colors.titleColor;
+    case LinkColor:
+        return colors.linkColor;
+    case SpecialColor:
+        return colors.specialColor;
+    case HighlightColor:
+        return colors.highlightColor;
+    case CodeColor:
+        return colors.codeColor;
+    case CodeBgColor:
+        return colors.codeBgColor;
+    case MathColor:
+        return colors.mathColor;
+    case NoColor:
+        break;
+    }
+    return {};
+}
+
+int EditorHighlighterPrivate::internFormat(const QTextCharFormat &format)
+{
+    // Only a few formats are used by a note, the most recent one is the most likely to come back
+    for (auto i = formatTable.size() - 1; 0 <= i; --i) {
+        if (formatTable.at(i) == format) {
+            return static_cast<int>(i);
         }
     }
+
+    formatTable.append(format);
+    return static_cast<int>(formatTable.size() - 1);
+}
+
+EditorHighlighterPrivate::Format &EditorHighlighterPrivate::lineFormat(const int line)
+{
+    auto &t = formats[line];
+    if (!t.block.isValid()) {
+        t.block = editor->document()->findBlockByNumber(line);
+    }
+    return t;
 }
 
-void EditorHighlighterPrivate::applyFormatChanges()
+void EditorHighlighterPrivate::paintRun(QList<FormatRun> &runs, const int start, const int end, const int formatId)
 {
-    bool formatsChanged = false;
+    if (end <= start) {
+        return;
+    }
+
+    // The overlapped runs are [first, last)
+    qsizetype first = std::lower_bound(runs.cbegin(),
+                                       runs.cend(),
+                                       start,
+                                       [](const FormatRun &run, const int column) {
+                                           return run.end() <= column;
+                                       })
+        - runs.cbegin();
+    qsizetype last = first;
+    while (last < runs.size() && runs.at(last).start < end) {
+        ++last;
+    }
+
+    // What is left of the overlapped runs on both sides
+    QList<FormatRun> pieces;
+    if (first < last && runs.at(first).start < start) {
+        const auto &run = runs.at(first);
+        pieces.append({run.start, start - run.start, run.formatId});
+    }
+    pieces.append({start, end - start, formatId});
+    if (first < last && end < runs.at(last - 1).end()) {
+        const auto &run = runs.at(last - 1);
+        pieces.append({end, run.end() - end, run.formatId});
+    }
+
+    // Merge with the touching neighbours sharing the format
+    if (0 < first && runs.at(first - 1).end() == pieces.constFirst().start && runs.at(first - 1).formatId == pieces.constFirst().formatId) {
+        --first;
+        pieces.first().start = runs.at(first).start;
+        pieces.first().length += runs.at(first).length;
+    }
+    if (last < runs.size() && pieces.constLast().end() == runs.at(last).start && pieces.constLast().formatId == runs.at(last).formatId) {
+        pieces.last().length += runs.at(last).length;
+        ++last;
+    }
+
+    QList<FormatRun> merged;
+    for (const auto &piece : std::as_const(pieces)) {
+        if (!merged.isEmpty() && merged.constLast().formatId == piece.formatId) {
+            merged.last().length += piece.length;
+        } else {
+            merged.append(piece);
+        }
+    }
+
+    runs.remove(first, last - first);
+    for (qsizetype i = 0; i < merged.size(); ++i) {
+        runs.insert(first + i, merged.at(i));
+    }
+}
 
+void EditorHighlighterPrivate::applyFormatChanges()
+{
     QTextLayout *layout = currentBlock.layout();
 
-    QList<QTextLayout::FormatRange> ranges = layout->formats();
+    const QList<QTextLayout::FormatRange> previousRanges = layout->formats();
+    QList<QTextLayout::FormatRange> ranges = previousRanges;
 
     const int preeditAreaStart = layout->preeditAreaPosition();
     const int preeditAreaLength = layout->preeditAreaText().size();
@@ -89,31 +466,21 @@ void EditorHighlighterPrivate::applyFormatChanges()
         auto isOutsidePreeditArea = [=](const QTextLayout::FormatRange &range) {
             return range.start < preeditAreaStart || range.start + range.length > preeditAreaStart + preeditAreaLength;
         };
-        if (ranges.removeIf(isOutsidePreeditArea) > 0)
-            formatsChanged = true;
-    } else if (!ranges.isEmpty()) {
+        ranges.removeIf(isOutsidePreeditArea);
+    } else {
         ranges.clear();
-        formatsChanged = true;
     }
 
-    int i = 0;
-    while (i < formatChanges.size()) {
-        QTextLayout::FormatRange r;
-
-        while (i < formatChanges.size() && formatChanges.at(i) == r.format)
-            ++i;
-
-        if (i == formatChanges.size())
-            break;
-
-        r.start = i;
-        r.format = formatChanges.at(i);
-
-        while (i < formatChanges.size() && formatChanges.at(i) == r.format)
-            ++i;
+    for (const auto &run : std::as_const(runChanges)) {
+        // The default format is left to the document
+        if (run.formatId == 0) {
+            continue;
+        }
 
-        Q_ASSERT(i <= formatChanges.size());
-        r.length = i - r.start;
+        QTextLayout::FormatRange r;
+        r.start = run.start;
+        r.length = run.length;
+        r.format = formatTable.at(run.formatId);
 
         if (preeditAreaLength != 0) {
             if (r.start >= preeditAreaStart)
@@ -123,17 +490,23 @@ void EditorHighlighterPrivate::applyFormatChanges()
         }
 
         ranges << r;
-        formatsChanged = true;
     }
 
-    if (formatsChanged) {
+    // Only relayout the blocks whose formats actually changed
+    if (ranges != previousRanges) {
         layout->setFormats(ranges);
-        editor->document()->markContentsDirty(currentBlock.position(), currentBlock.length());
+        addDirtyRange(currentBlock.position(), currentBlock.length());
     }
 }
 
-QFont EditorHighlighterPrivate::styleFont(int opts, bool isSpecial) const
+QFont EditorHighlighterPrivate::styleFont(int opts, bool isSpecial)
 {
+    const quint64 key = (static_cast<quint64>(static_cast<unsigned int>(opts)) << 4) | (static_cast<quint64>(headingLevel) << 1) | (isSpecial ? 1 : 0);
+    const auto it = fonts.constFind(key);
+    if (it != fonts.cend()) {
+        return it.value();
+    }
+
     auto f = font;
     auto size = f.pointSize();
     if (!isSpecial || adaptiveTagSize) {
@@ -173,6 +546,7 @@ QFont EditorHighlighterPrivate::styleFont(int opts, bool isSpecial) const
     if (opts & MD::StrikethroughText)
         f.setStrikeOut(true);
 
+    fonts.insert(key, f);
     return f;
 }
 
@@ -322,18 +696,14 @@ void EditorHighlighterPrivate::restoreCachedFormats()
 
 void EditorHighlighterPrivate::revertFormat(const MD::WithPosition &withPosition)
 {
-    for (int j = withPosition.startColumn(); j < withPosition.endColumn() + 1; ++j) {
-        const auto line = withPosition.startLine();
-        if (!cachedFormats.contains(line)) {
-            cachedFormats[line] = formats[line];
-        }
-        auto &t = formats[line];
-        QTextCharFormat defaultFormat;
-        defaultFormat.setForeground(colors.specialColor);
-        defaultFormat.setFont(styleFont(0));
-
-        t.formats[j] = defaultFormat;
+    const auto line = withPosition.startLine();
+    if (!cachedFormats.contains(line)) {
+        cachedFormats[line] = formats[line];
     }
+
+    auto &t = lineFormat(line);
+    const int end = std::min(static_cast<int>(withPosition.endColumn()) + 1, t.block.length() - 1);
+    paintRun(t.runs, withPosition.startColumn(), end, formatId(SpecialColor, MD::TextWithoutFormat));
 }
 
 void EditorHighlighterPrivate::revertFormats(const posCacheUtils::DelimsInfo &delimInfo)
@@ -6,11 +6,15 @@
 #include "logic/editor/posCacheUtils.hpp"
 
 // Qt include.
+#include <QHash>
 #include <QTextBlock>
 #include <QTextCharFormat>
 #include <QTextCursor>
 #include <QTextEdit>
 
+// C++ include
+#include <limits>
+
 using namespace Qt::Literals::StringLiterals;
 
 namespace MdEditor
@@ -18,6 +22,60 @@ namespace MdEditor
 class EditorHighlighterPrivate
 {
 public:
+    // A span of a line sharing the same format
+    struct FormatRun {
+        int start = 0;
+        int length = 0;
+        int formatId = 0;
+
+        int end() const
+        {
+            return start + length;
+        }
+    };
+
+    struct Format {
+        QTextBlock block;
+        // Sorted and non overlapping
+        QList<FormatRun> runs;
+    };
+
+    // The colors of the theme a format can use
+    enum ColorRole : quint8 {
+        NoColor,
+        TextColor,
+        TitleColor,
+        LinkColor,
+        SpecialColor,
+        HighlightColor,
+        CodeColor,
+        CodeBgColor,
+        MathColor,
+    };
+
+    // Everything a format depends on, besides the theme and the settings
+    struct FormatKey {
+        long long int opts = 0;
+        int headingLevel = 0;
+        ColorRole foreground = NoColor;
+        ColorRole background = NoColor;
+        bool isSpecial = false;
+        bool underline = false;
+        // Built by `makeFormat`, using the extended syntaxes
+        bool isText = false;
+
+        bool operator==(const FormatKey &other) const
+        {
+            return opts == other.opts && headingLevel == other.headingLevel && foreground == other.foreground && background == other.background
+                && isSpecial == other.isSpecial && underline == other.underline && isText == other.isText;
+        }
+
+        friend size_t qHash(const FormatKey &key, size_t seed = 0) noexcept
+        {
+            return qHashMulti(seed, key.opts, key.headingLevel, static_cast<int>(key.foreground), static_cast<int>(key.background), key.isSpecial, key.underline, key.isText);
+        }
+    };
+
     EditorHighlighterPrivate(EditorHandler *e);
 
     /**
@@ -25,29 +83,183 @@ public:
      */
     void clearFormats();
 
+    /**
+     * @brief Forget the computed formats without touching the editor, the next `applyFormats` will only update the blocks that changed.
+     */
+    void resetFormats();
+
     /**
      * @brief Apply formating to the editor.
+     * Blocks formatted by the previous call but absent from the current formats are cleared.
      */
     void applyFormats();
 
+    /**
+     * @brief Apply the formats of the given lines first, the other lines are left pending for `applyPendingFormats`.
+     * The pending lines are ordered by their distance to the cursor.
+     *
+     * @param firstLine The first line to apply right away.
+     * @param lastLine The last line to apply right away.
+     * @param cursorLine The line of the cursor.
+     */
+    void startProgressiveApply(const int firstLine, const int lastLine, const int cursorLine);
+
+    /**
+     * @brief Apply the pending formats until the given budget is spent.
+     *
+     * @param budget The time budget in milliseconds.
+     * @return True if there is no more pending formats, false otherwise.
+     */
+    bool applyPendingFormats(const int budget);
+
+    /**
+     * @brief Check if some formats are still waiting to be applied.
+     *
+     * @return True if some formats are pending, false otherwise.
+     */
+    bool hasPendingFormats() const;
+
+    /**
+     * @brief Drop the pending formats, used when the text changes before they could be applied.
+     */
+    void cancelPendingFormats();
+
+    /**
+     * @brief Apply the formats of the given lines only.
+     *
+     * @param lines The lines to apply.
+     */
+    void applyLines(const QList<int> &lines);
+
+    /**
+     * @brief Apply the formats of the given line, if any.
+     *
+     * @param line The line to apply.
+     */
+    void applyLine(const int line);
+
+    /**
+     * @brief Remove the formats of the previously highlighted lines that are not part of the current formats.
+     *
+     * @param firstLine The first line to check.
+     * @param lastLine The last line to check.
+     */
+    void clearStaleFormats(const int firstLine = 0, const int lastLine = std::numeric_limits<int>::max());
+
+    /**
+     * @brief Add the given lines to the formatted ones.
+     *
+     * @param lines The newly formatted lines.
+     */
+    void addFormattedLines(QList<int> lines);
+
+    /**
+     * @brief Keep track of the highlighted lines when the text is edited.
+     *
+     * @param edit The lines touched by the edit.
+     */
+    void moveFormattedLines(const TextEdit &edit);
+
+    /**
+     * @brief Remove the formats of the given block.
+     *
+     * @param block The block to clear.
+     */
+    void clearBlockFormats(const QTextBlock &block);
+
+    /**
+     * @brief Add a range of the document in need of a relayout.
+     *
+     * @param position The position of the range in the document.
+     * @param length The length of the range.
+     */
+    void addDirtyRange(const int position, const int length);
+
+    /**
+     * @brief Relayout the dirty ranges, merging the contiguous ones.
+     */
+    void flushDirtyRanges();
+
+    /**
+     * @brief Get the id of the format with the given style, for the current heading level.
+     *
+     * @param foreground The foreground color of the format.
+     * @param opts The style options which will affect the font.
+     * @param isSpecial Whether the format is special, for example, if it is used for the delims.
+     * @param background The background color of the format.
+     * @param underline Whether the text is underlined.
+     * @return The id of the format in the format table.
+     */
+    int formatId(const ColorRole foreground, const long long int opts, const bool isSpecial = false, const ColorRole background = NoColor, const bool underline = false);
+
+    /**
+     * @brief Get the id of the format of a text with the given options, for the current heading level.
+     * The extended syntaxes are taken into account.
+     *
+     * @param opts The style options of the text.
+     * @return The id of the format in the format table.
+     */
+    int textFormatId(const long long int opts);
+
+    /**
+     * @brief Forget the precomputed fonts and formats, used when the theme or the settings change.
+     * The format table itself is shrunk with the next `resetFormats`, the current runs still use it.
+     */
+    void invalidateFormatTable();
+
+    /**
+     * @brief Get the color corresponding to the given role.
+     *
+     * @param role The role of the color.
+     * @return The color of the current theme.
+     */
+    QColor roleColor(const ColorRole role) const;
+
+    /**
+     * @brief Get the id of the given format, adding it to the format table if needed.
+     *
+     * @param format The format to intern.
+     * @return The index of the format in the format table.
+     */
+    int internFormat(const QTextCharFormat &format);
+
+    /**
+     * @brief Get the formats of the given line, creating them if needed.
+     *
+     * @param line The line of the formats.
+     * @return The formats of the line.
+     */
+    Format &lineFormat(const int line);
+
+    /**
+     * @brief Paint the given format on the given columns, replacing the overlapped runs.
+     * The runs are kept sorted and the contiguous runs sharing a format are merged.
+     *
+     * @param runs The runs of the line.
+     * @param start The first column to paint.
+     * @param end The column after the last one to paint.
+     * @param formatId The id of the format to paint.
+     */
+    void paintRun(QList<FormatRun> &runs, const int start, const int end, const int formatId);
+
     /**
      * @brief Apply the given format to the given position.
      *
-     * @param format The format to apply.
+     * @param formatId The id of the format to apply.
      * @param pos The position on which to apply the format.
      */
-    void setFormat(const QTextCharFormat &format, const MD::WithPosition &pos);
+    void setFormat(const int formatId, const MD::WithPosition &pos);
 
     /**
      * @brief Apply the given format to the given position.
      *
-     * @param format The format to apply.
+     * @param formatId The id of the format to apply.
      * @param startLine The starting line on which to apply the format.
      * @param startColumn The starting column on which to apply the format.
      * @param endLine The ending line on which to apply the format.
      * @param endColumn The ending column on which to apply the format.
      */
-    void setFormat(const QTextCharFormat &format, long long int startLine, long long int startColumn, long long int endLine, long long int endColumn);
+    void setFormat(const int formatId, long long int startLine, long long int startColumn, long long int endLine, long long int endColumn);
 
     /**
      * @brief Apply formats that have changed.
@@ -56,12 +268,13 @@ public:
 
     /**
      * @brief Style the font based on the given information.
+     * The fonts are computed once per heading level and options.
      *
      * @param opts The style options which will affect the font.
      * @param isSpecial Whether the font is special, for example, if it is used for the delims.
      * @return A font styled based on the given info.
      */
-    QFont styleFont(int opts, bool isSpecial = false) const;
+    QFont styleFont(int opts, bool isSpecial = false);
 
     // KleverNotes
     /**
@@ -116,17 +329,27 @@ public:
     int additionalStyle = 0;
     // Current text block.
     QTextBlock currentBlock;
-    // Formats for current block.
-    QList<QTextCharFormat> formatChanges;
-
-    struct Format {
-        QTextBlock block;
-        QList<QTextCharFormat> formats;
-    };
+    // Format runs for current block.
+    QList<FormatRun> runChanges;
+    // Formats used by the runs, the default format is always the first one.
+    QList<QTextCharFormat> formatTable = {QTextCharFormat()};
+    // Precomputed format ids and fonts, rebuilt when the theme or the settings change.
+    QHash<FormatKey, int> formatIds;
+    QHash<quint64, QFont> fonts;
+    bool staleFormatTable = false;
 
     // Formats.
     QMap<int, Format> formats;
     QMap<int, Format> cachedFormats;
+    // Lines on which formats have been applied, sorted.
+    QList<int> formattedLines;
+    // Whether the formatted lines are unknown and every block must be checked.
+    bool checkAllLines = true;
+    // Lines waiting to be applied, by priority.
+    QList<int> pendingLines;
+    qsizetype pendingIndex = 0;
+    // Ranges of the document waiting for a relayout, as (position, length).
+    QList<std::pair<int, int>> dirtyRanges;
     int headingLevel = 0;
 
     // KleverNotes
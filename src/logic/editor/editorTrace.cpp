@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+
+#include "editorTrace.hpp"
+
+// Qt include
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+
+// C++ include
+#include <atomic>
+
+namespace
+{
+// The preview page runs in the WebEngine process, its events get their own track
+static constexpr int PREVIEW_TID = 0;
+
+struct Trace {
+    QMutex mutex;
+    QFile file;
+    QElapsedTimer clock;
+    QByteArray pid;
+    bool firstEvent = true;
+    std::atomic<int> lastTid = PREVIEW_TID;
+    // Parsing number of the last HTML handed to the preview
+    std::atomic<unsigned long long int> previewId = 0;
+};
+
+void write(Trace *trace, const QByteArray &event)
+{
+    const QMutexLocker locker(&trace->mutex);
+    // The array is never closed, the format allows it and the trace stays valid if KleverNotes is killed
+    trace->file.write(trace->firstEvent ? "[\n" : ",\n");
+    trace->file.write(event);
+    trace->firstEvent = false;
+}
+
+QByteArray metadata(Trace *trace, const int tid, const QString &threadName)
+{
+    return "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + trace->pid + ",\"tid\":" + QByteArray::number(tid) + ",\"args\":{\"name\":\""
+        + threadName.toUtf8() + "\"}}";
+}
+
+Trace *trace()
+{
+    // Never deleted, the other threads can still record events while the application exits
+    static Trace *const trace = []() -> Trace * {
+        const QString path = qEnvironmentVariable("KLEVERNOTES_TRACE_FILE");
+        if (path.isEmpty()) {
+            return nullptr;
+        }
+
+        auto result = new Trace;
+        result->file.setFileName(path);
+        // Unbuffered, nothing is lost when the application exits
+        if (!result->file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+            qWarning() << "Can't write the editor trace to" << path;
+            delete result;
+            return nullptr;
+        }
+        result->pid = QByteArray::number(QCoreApplication::applicationPid());
+        result->clock.start();
+
+        write(result, metadata(result, PREVIEW_TID, QStringLiteral("Preview page")));
+        return result;
+    }();
+    return trace;
+}
+
+QByteArray currentTid(Trace *trace)
+{
+    thread_local int tid = PREVIEW_TID;
+    if (tid == PREVIEW_TID) {
+        tid = ++trace->lastTid;
+
+        const QThread *thread = QThread::currentThread();
+        QString threadName = thread->objectName();
+        if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+            threadName = QStringLiteral("GUI");
+        } else if (threadName.isEmpty()) {
+            threadName = QStringLiteral("Thread %1").arg(tid);
+        }
+        write(trace, metadata(trace, tid, threadName));
+    }
+    return QByteArray::number(tid);
+}
+
+qint64 now(Trace *trace)
+{
+    return trace->clock.nsecsElapsed() / 1000;
+}
+
+QByteArray event(Trace *trace, const char *name, const char *phase, const qint64 timestamp, const QByteArray &tid)
+{
+    return QByteArray("{\"name\":\"") + name + "\",\"cat\":\"editor\",\"ph\":\"" + phase + "\",\"ts\":" + QByteArray::number(timestamp) + ",\"pid\":" + trace->pid
+        + ",\"tid\":" + tid;
+}
+
+QByteArray args(const unsigned long long int id)
+{
+    return id == 0 ? QByteArray("}") : ",\"args\":{\"parse\":" + QByteArray::number(id) + "}}";
+}
+}
+
+namespace editorTrace
+{
+bool isEnabled()
+{
+    return trace();
+}
+
+void instant(const char *name, const unsigned long long int id)
+{
+    auto *t = trace();
+    if (!t) {
+        return;
+    }
+
+    write(t, event(t, name, "i", now(t), currentTid(t)) + ",\"s\":\"t\"" + args(id));
+}
+
+void asyncBegin(const char *name, const unsigned long long int id)
+{
+    auto *t = trace();
+    if (!t) {
+        return;
+    }
+
+    write(t, event(t, name, "b", now(t), currentTid(t)) + ",\"id\":" + QByteArray::number(id) + args(id));
+}
+
+void asyncEnd(const char *name, const unsigned long long int id)
+{
+    auto *t = trace();
+    if (!t) {
+        return;
+    }
+
+    write(t, event(t, name, "e", now(t), currentTid(t)) + ",\"id\":" + QByteArray::number(id) + args(id));
+}
+
+void counter(const char *name, const qint64 value)
+{
+    auto *t = trace();
+    if (!t) {
+        return;
+    }
+
+    write(t, event(t, name, "C", now(t), currentTid(t)) + ",\"args\":{\"value\":" + QByteArray::number(value) + "}}");
+}
+
+void handedToPreview(const unsigned long long int id)
+{
+    auto *t = trace();
+    if (!t) {
+        return;
+    }
+
+    t->previewId = id;
+    instant("webChannel", id);
+}
+
+void previewUpdated(const double durationMs)
+{
+    auto *t = trace();
+    if (!t) {
+        return;
+    }
+
+    // Reported once the page is done, the span is placed right before the report
+    const qint64 duration = static_cast<qint64>(durationMs * 1000);
+    const unsigned long long int id = t->previewId;
+    write(t, event(t, "innerHTML", "X", now(t) - duration, QByteArray::number(PREVIEW_TID)) + ",\"dur\":" + QByteArray::number(duration) + args(id));
+    asyncEnd("edit", id);
+}
+
+Span::Span(const char *name, const unsigned long long int id)
+    : m_name(name)
+    , m_id(id)
+    , m_start(trace() ? now(trace()) : 0)
+{
+}
+
+Span::~Span()
+{
+    auto *t = trace();
+    if (!t) {
+        return;
+    }
+
+    write(t, event(t, m_name, "X", m_start, currentTid(t)) + ",\"dur\":" + QByteArray::number(now(t) - m_start) + args(m_id));
+}
+}
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+
+#pragma once
+
+// Qt include
+#include <QtGlobal>
+
+/**
+ * Opt-in tracing of the stages of an edit, from the keystroke to the preview.
+ *
+ * Enabled by setting `KLEVERNOTES_TRACE_FILE` to the path of the trace to write.
+ * The trace uses the Chrome trace event JSON format, it can be opened in Perfetto or `chrome://tracing`.
+ * Each parsing is identified by its parsing number, the whole edit is an async "edit" span.
+ * When disabled, every call returns right away.
+ */
+namespace editorTrace
+{
+/**
+ * @brief Check if the tracing is enabled.
+ *
+ * @return True if the events are recorded, false otherwise.
+ */
+bool isEnabled();
+
+/**
+ * @brief Record an event without duration on the current thread.
+ *
+ * @param name The name of the event, must outlive the tracing.
+ * @param id The parsing number the event belongs to, 0 if none.
+ */
+void instant(const char *name, const unsigned long long int id = 0);
+
+/**
+ * @brief Start a span that can end on another thread.
+ *
+ * @param name The name of the span, must outlive the tracing.
+ * @param id The parsing number identifying the span.
+ */
+void asyncBegin(const char *name, const unsigned long long int id);
+
+/**
+ * @brief End a span started by `asyncBegin`.
+ *
+ * @param name The name of the span.
+ * @param id The parsing number identifying the span.
+ */
+void asyncEnd(const char *name, const unsigned long long int id);
+
+/**
+ * @brief Record the value of a counter, shown as a graph over time.
+ *
+ * @param name The name of the counter, must outlive the tracing.
+ * @param value The current value.
+ */
+void counter(const char *name, const qint64 value);
+
+/**
+ * @brief Record that the HTML of the given parsing is handed to the preview through the WebChannel.
+ *
+ * @param id The parsing number of the HTML.
+ */
+void handedToPreview(const unsigned long long int id);
+
+/**
+ * @brief Record that the preview page applied the last HTML handed to it, this ends its edit span.
+ *
+ * @param durationMs The time spent by the page to apply the HTML, in milliseconds.
+ */
+void previewUpdated(const double durationMs);
+
+/**
+ * @class Span
+ * @brief Record the lifetime of the scope as a span of the current thread.
+ */
+class Span
+{
+public:
+    /**
+     * @param name The name of the span, must outlive the tracing.
+     * @param id The parsing number the span belongs to, 0 if none.
+     */
+    explicit Span(const char *name, const unsigned long long int id = 0);
+    ~Span();
+
+    Q_DISABLE_COPY(Span)
+
+private:
+    const char *m_name;
+    const unsigned long long int m_id;
+    const qint64 m_start;
+};
+}
@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+
+#include "parseScheduler.hpp"
+
+// C++ include
+#include <algorithm>
+#include <cmath>
+
+// Below this cost, the parsing is fast enough to follow every keystroke
+static constexpr double IMMEDIATE_COST = 8.;
+// Longest debounce window, even for huge notes
+static constexpr int MAX_BUDGET = 80;
+// Weight of the newest measure in the average cost
+static constexpr double COST_WEIGHT = 0.3;
+
+namespace MdEditor
+{
+ParseScheduler::ParseScheduler(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &ParseScheduler::flush);
+}
+
+void ParseScheduler::requestParse()
+{
+    if (m_pending) {
+        setDroppedRequests(m_droppedRequests + 1);
+    } else {
+        m_pending = true;
+        m_pendingSince.start();
+    }
+
+    // The request will be sent once the current parsing is done
+    if (!m_inFlight) {
+        startTimer();
+    }
+}
+
+void ParseScheduler::parseFinished(const qint64 cost)
+{
+    m_inFlight = false;
+
+    m_averageCost = m_averageCost < 0 ? cost : COST_WEIGHT * cost + (1 - COST_WEIGHT) * m_averageCost;
+    updateBudget();
+
+    if (m_pending) {
+        startTimer();
+    }
+}
+
+void ParseScheduler::parseCancelled()
+{
+    m_inFlight = false;
+
+    if (m_pending) {
+        m_timer->stop();
+        flush();
+    }
+}
+
+void ParseScheduler::reset()
+{
+    m_timer->stop();
+    m_pending = false;
+    m_inFlight = false;
+    m_averageCost = -1;
+    updateBudget();
+    setDroppedRequests(0);
+}
+
+bool ParseScheduler::hasPendingRequest() const
+{
+    return m_pending;
+}
+
+int ParseScheduler::budget() const
+{
+    return m_budget;
+}
+
+int ParseScheduler::droppedRequests() const
+{
+    return m_droppedRequests;
+}
+
+void ParseScheduler::flush()
+{
+    if (!m_pending || m_inFlight) {
+        return;
+    }
+
+    m_pending = false;
+    m_inFlight = true;
+    Q_EMIT parseRequested();
+}
+
+void ParseScheduler::startTimer()
+{
+    // Keep the debounce from postponing the parsing forever while typing
+    if (m_timer->isActive() && 2 * m_budget <= m_pendingSince.elapsed()) {
+        return;
+    }
+
+    // A 0ms timer still coalesces the edits made during the same event loop iteration
+    m_timer->start(m_budget);
+}
+
+void ParseScheduler::updateBudget()
+{
+    const int budget = m_averageCost < IMMEDIATE_COST ? 0 : std::min(MAX_BUDGET, static_cast<int>(std::ceil(m_averageCost)));
+
+    if (budget != m_budget) {
+        m_budget = budget;
+        Q_EMIT budgetChanged();
+    }
+}
+
+void ParseScheduler::setDroppedRequests(const int droppedRequests)
+{
+    if (droppedRequests != m_droppedRequests) {
+        m_droppedRequests = droppedRequests;
+        Q_EMIT droppedRequestsChanged();
+    }
+}
+}
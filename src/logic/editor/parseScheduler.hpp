@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+
+#pragma once
+
+// Qt include
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+namespace MdEditor
+{
+/**
+ * @class ParseScheduler
+ * @brief Class deciding when the editor content should be sent to the parser.
+ *
+ * Only one parsing is in flight at a time, the edits made in the meantime are coalesced into a single request.
+ * The debounce window is chosen from the recent cost of a parse + highlight cycle of the current note.
+ */
+class ParseScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ParseScheduler(QObject *parent = nullptr);
+
+    /**
+     * @brief Ask for the editor content to be parsed.
+     * The request is coalesced with the pending ones and sent once the debounce window has elapsed.
+     */
+    void requestParse();
+
+    /**
+     * @brief Inform the scheduler that the requested parsing has been handled.
+     *
+     * @param cost The time, in milliseconds, taken by the parse + highlight cycle.
+     */
+    void parseFinished(const qint64 cost);
+
+    /**
+     * @brief Inform the scheduler that the requested parsing was aborted in favor of a newer text.
+     * The pending request is sent right away, the aborted parsing does not count in the average cost.
+     */
+    void parseCancelled();
+
+    /**
+     * @brief Forget the measured cost and the pending requests, used when opening another note.
+     */
+    void reset();
+
+    /**
+     * @brief Check if a request is waiting to be sent to the parser.
+     *
+     * @return True if a request is pending, false otherwise.
+     */
+    bool hasPendingRequest() const;
+
+    /**
+     * @brief Get the current debounce window.
+     *
+     * @return The debounce window in milliseconds.
+     */
+    int budget() const;
+
+    /**
+     * @brief Get the number of requests coalesced into another one since the note was opened.
+     *
+     * @return The number of dropped requests.
+     */
+    int droppedRequests() const;
+
+Q_SIGNALS:
+    /**
+     * @brief The editor content should be sent to the parser now.
+     */
+    void parseRequested();
+
+    /**
+     * @brief The debounce window has changed.
+     */
+    void budgetChanged();
+
+    /**
+     * @brief The number of dropped requests has changed.
+     */
+    void droppedRequestsChanged();
+
+private:
+    /**
+     * @brief Send the pending request.
+     */
+    void flush();
+
+    /**
+     * @brief (Re)start the debounce timer, unless the oldest pending request waited too long already.
+     */
+    void startTimer();
+
+    /**
+     * @brief Compute the debounce window from the average cost.
+     */
+    void updateBudget();
+
+    /**
+     * @brief Set the number of dropped requests.
+     *
+     * @param droppedRequests The new number of dropped requests.
+     */
+    void setDroppedRequests(const int droppedRequests);
+
+private:
+    QTimer *m_timer = nullptr;
+    QElapsedTimer m_pendingSince;
+
+    bool m_pending = false;
+    bool m_inFlight = false;
+
+    double m_averageCost = -1; // Exponential moving average, in milliseconds
+    int m_budget = 0;
+    int m_droppedRequests = 0;
+};
+}
@@ -13,6 +13,7 @@
 
 // Qt include.
 #include <QDebug>
+#include <QSet>
 
 static const int USERDEFINEDINT = static_cast<int>(MD::ItemType::UserDefined);
 
@@ -151,9 +152,7 @@ void addHeadingDelims(QList<posCacheUtils::DelimsInfo> &delims, MD::Item *item,
             break;
         }
         const posCacheUtils::DelimsInfo delimInfo = {headingLevel, delimType, delim};
-        if (!delims.contains(delimInfo)) {
-            delims.append(delimInfo);
-        }
+        delims.append(delimInfo);
     }
 }
 
@@ -210,7 +209,7 @@ void addBlockItemDelims(QList<posCacheUtils::DelimsInfo> &delims, MD::Item *item
         qWarning() << "addBlockItemDelims: Unsupported block item" << static_cast<int>(item->type());
     }
 
-    if (delimInfo.opening.startLine() != -1 && !delims.contains(delimInfo)) {
+    if (delimInfo.opening.startLine() != -1) {
         delims.append(delimInfo);
     }
 }
@@ -233,29 +232,25 @@ inline bool isBetweenDelims(const MD::WithPosition value, const MD::WithPosition
 }
 
 /**
- * @brief Create and add all the DelimsInfo found inside the item to `delims`.
+ * @brief Get the open/close pairs of the item, computing them on the first call for this parsing.
  *
- * @param delims A list of DelimsInfo where all the new DelimsInfo will be added.
+ * @param pairsCache The open/close pairs already computed.
  * @param item The item being treated.
- * @param cursorPos The position of the cursor.
- * @param selectStartPos The position where the selection starts. If there's no selection, this is equal to `pos`.
- * @param selectEndPos The position where the selection ends. If there's no selection, this is equal to `pos`.
  * @param headingLevel The heading level of the newly created DelimsInfo.
+ * @return The open/close pairs of the item.
  */
-void addSurroundingDelimsPairs(QList<posCacheUtils::DelimsInfo> &delims,
-                               MD::Item *item,
-                               const MD::WithPosition &cursorPos,
-                               const MD::WithPosition &selectStartPos,
-                               const MD::WithPosition &selectEndPos,
-                               const int headingLevel)
+const QList<posCacheUtils::DelimsInfo> &getOpenCloseDelimsPairs(posCacheUtils::PairsCache &pairsCache, MD::Item *item, const int headingLevel)
 {
-    auto items = getInnerItems(item);
+    const auto it = pairsCache.constFind(item);
+    if (it != pairsCache.cend()) {
+        return it.value();
+    }
 
     QList<MD::WithPosition> waitingOpeningDelims;
     QList<posCacheUtils::DelimsInfo> openCloseDelims;
 
-    for (const auto &item : items) {
-        getOpenCloseDelims(item.get(), waitingOpeningDelims, openCloseDelims, headingLevel);
+    for (const auto &innerItem : getInnerItems(item)) {
+        getOpenCloseDelims(innerItem.get(), waitingOpeningDelims, openCloseDelims, headingLevel);
     }
 
     if (!waitingOpeningDelims.isEmpty()) {
@@ -263,9 +258,33 @@ void addSurroundingDelimsPairs(QList<posCacheUtils::DelimsInfo> &delims,
         for (const auto &delim : waitingOpeningDelims) {
             qWarning() << delim.startColumn() << delim.startLine() << delim.endColumn() << delim.endLine();
         }
-        return;
+        openCloseDelims.clear();
     }
 
+    return pairsCache.insert(item, openCloseDelims).value();
+}
+
+/**
+ * @brief Create and add all the DelimsInfo found inside the item to `delims`.
+ *
+ * @param delims A list of DelimsInfo where all the new DelimsInfo will be added.
+ * @param pairsCache The open/close pairs already computed.
+ * @param item The item being treated.
+ * @param cursorPos The position of the cursor.
+ * @param selectStartPos The position where the selection starts. If there's no selection, this is equal to `pos`.
+ * @param selectEndPos The position where the selection ends. If there's no selection, this is equal to `pos`.
+ * @param headingLevel The heading level of the newly created DelimsInfo.
+ */
+void addSurroundingDelimsPairs(QList<posCacheUtils::DelimsInfo> &delims,
+                               posCacheUtils::PairsCache &pairsCache,
+                               MD::Item *item,
+                               const MD::WithPosition &cursorPos,
+                               const MD::WithPosition &selectStartPos,
+                               const MD::WithPosition &selectEndPos,
+                               const int headingLevel)
+{
+    const auto &openCloseDelims = getOpenCloseDelimsPairs(pairsCache, item, headingLevel);
+
     for (const auto &delimInfo : openCloseDelims) {
         const auto &openDelim = delimInfo.opening;
         const auto &closeDelim = delimInfo.closing;
@@ -277,9 +296,7 @@ void addSurroundingDelimsPairs(QList<posCacheUtils::DelimsInfo> &delims,
         }
 
         if (addPair) {
-            if (!delims.contains(delimInfo)) {
-                delims.append(delimInfo);
-            }
+            delims.append(delimInfo);
         }
     }
 }
@@ -292,7 +309,28 @@ bool operator==(const DelimsInfo &d1, const DelimsInfo &d2)
     return (d1.opening == d2.opening && d1.closing == d2.closing);
 }
 
+size_t qHash(const DelimsInfo &delimInfo, size_t seed) noexcept
+{
+    const auto &o = delimInfo.opening;
+    const auto &c = delimInfo.closing;
+    return qHashMulti(seed, o.startColumn(), o.startLine(), o.endColumn(), o.endLine(), c.startColumn(), c.startLine(), c.endColumn(), c.endLine());
+}
+
+void removeDuplicates(QList<DelimsInfo> &delims)
+{
+    QSet<DelimsInfo> seen;
+    seen.reserve(delims.size());
+    delims.removeIf([&seen](const DelimsInfo &delimInfo) {
+        if (seen.contains(delimInfo)) {
+            return true;
+        }
+        seen.insert(delimInfo);
+        return false;
+    });
+}
+
 void addDelimsFromItems(QList<posCacheUtils::DelimsInfo> &delims,
+                        PairsCache &pairsCache,
                         const Items &items,
                         const MD::WithPosition &pos,
                         const MD::WithPosition &selectStartPos,
@@ -307,7 +345,7 @@ void addDelimsFromItems(QList<posCacheUtils::DelimsInfo> &delims,
     if (2 <= cacheLen) {
         const auto &secondToLast = items.at(cacheLen - 2);
 
-        addSurroundingDelimsPairs(delims, secondToLast, pos, selectStartPos, selectEndPos, headingLevel);
+        addSurroundingDelimsPairs(delims, pairsCache, secondToLast, pos, selectStartPos, selectEndPos, headingLevel);
     }
 }
 }
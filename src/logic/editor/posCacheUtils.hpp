@@ -8,6 +8,9 @@
 // md4qt include.
 #include <md4qt/src/doc.h>
 
+// Qt include.
+#include <QHash>
+
 using ItemSharedPointer = QSharedPointer<MD::Item>;
 using SharedItems = QVector<ItemSharedPointer>;
 using Items = QVector<MD::Item *>;
@@ -49,16 +52,38 @@ enum BlockDelimTypes {
  */
 bool operator==(const DelimsInfo &d1, const DelimsInfo &d2);
 
+/**
+ * @brief Hash a DelimsInfo based on its opening and closing, consistent with `operator==`.
+ *
+ * @param delimInfo The DelimsInfo to hash.
+ * @param seed The hash seed.
+ * @return The hash value.
+ */
+size_t qHash(const DelimsInfo &delimInfo, size_t seed = 0) noexcept;
+
+// The open/close pairs of an inline container (paragraph, heading text), computed once per parsing
+using PairsCache = QHash<const MD::Item *, QList<DelimsInfo>>;
+
+/**
+ * @brief Remove the duplicated DelimsInfo, keeping the first occurrence of each one.
+ *
+ * @param delims The list of DelimsInfo.
+ */
+void removeDuplicates(QList<DelimsInfo> &delims);
+
 /**
  * @brief Add all the delims found inside the items that surround the `selectStartPos` and the `selectEndPos` to the `delims` list.
+ * The same DelimsInfo might be added several times, see `removeDuplicates`.
  *
  * @param delims A list of DelimsInfo where all the new DelimsInfo will be added.
+ * @param pairsCache The open/close pairs already computed for the current parsing.
  * @param items A vector of items in which we will look for delims.
  * @param pos The current cursor position.
  * @param selectStartPos The position where the selection starts. If there's no selection, this is equal to `pos`.
  * @param selectEndPos The position where the selection ends. If there's no selection, this is equal to `pos`.
  */
 void addDelimsFromItems(QList<DelimsInfo> &delims,
+                        PairsCache &pairsCache,
                         const Items &items,
                         const MD::WithPosition &pos,
                         const MD::WithPosition &selectStartPos = {},
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+
+#include "positionIndex.hpp"
+
+// C++ include
+#include <algorithm>
+
+namespace MdEditor
+{
+void PositionIndex::build(const PosRanges &cache)
+{
+    clear();
+
+    m_ranges = cache;
+    if (m_ranges.isEmpty()) {
+        return;
+    }
+
+    const qsizetype lineCount = std::max<qsizetype>(0, m_ranges.constLast()->m_endLine + 1);
+    m_lines.fill({0, 0}, lineCount);
+
+    for (qsizetype i = 0; i < m_ranges.size(); ++i) {
+        const auto &range = m_ranges.at(i);
+        for (auto line = std::max<qsizetype>(0, range->m_startLine); line <= range->m_endLine && line < lineCount; ++line) {
+            auto &[first, last] = m_lines[line];
+            if (first == last) {
+                first = i;
+            }
+            last = i + 1;
+        }
+    }
+}
+
+void PositionIndex::clear()
+{
+    m_ranges.clear();
+    m_lines.clear();
+}
+
+Items PositionIndex::itemsAt(const long long int line, const long long int column) const
+{
+    Items res;
+    if (line < 0 || m_lines.size() <= line) {
+        return res;
+    }
+
+    const MD::details::PosRange pos(column, line, column, line);
+
+    // The ranges before the line are all lower than the position
+    const auto &[first, last] = m_lines.at(line);
+    auto it = std::lower_bound(m_ranges.cbegin() + first, m_ranges.cbegin() + last, pos, MD::comparePosRangeLower);
+    if (it == m_ranges.cbegin() + last || !(*it->get() == pos)) {
+        return res;
+    }
+
+    // Same walk as MD::PosCache::findFirstInCache, the nested items are few
+    while (true) {
+        res.push_back(it->get()->m_item);
+
+        const auto &children = it->get()->m_children;
+        it = std::lower_bound(children.cbegin(), children.cend(), pos, MD::comparePosRangeLower);
+        if (it == children.cend() || !(*it->get() == pos)) {
+            break;
+        }
+    }
+
+    return res;
+}
+
+bool PositionIndex::hasItems(const long long int line) const
+{
+    if (line < 0 || m_lines.size() <= line) {
+        return false;
+    }
+
+    const auto &[first, last] = m_lines.at(line);
+    return first != last;
+}
+}
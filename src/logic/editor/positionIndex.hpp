@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+
+#pragma once
+
+// KleverNotes include
+#include "logic/editor/posCacheUtils.hpp"
+
+// md4qt include
+#include <md4qt/src/poscache.h>
+
+// Qt include
+#include <QList>
+#include <QSharedPointer>
+
+namespace MdEditor
+{
+/**
+ * @class PositionIndex
+ * @brief Class indexing the positions cache of a parsed document by line.
+ *
+ * The top level items of the cache are sorted and do not overlap, each line is mapped to the ones it holds.
+ * Finding the items at a position is then a direct access to its line, followed by a search among the (few) nested items.
+ */
+class PositionIndex
+{
+public:
+    using PosRanges = QVector<QSharedPointer<MD::details::PosRange>>;
+
+    /**
+     * @brief Index the given positions cache, to be done once per parsing.
+     *
+     * @param cache The top level items of the positions cache.
+     */
+    void build(const PosRanges &cache);
+
+    /**
+     * @brief Forget the indexed cache.
+     */
+    void clear();
+
+    /**
+     * @brief Get the items covering the given position, from the block to the most nested one.
+     * Same result as `MD::PosCache::findFirstInCache`.
+     *
+     * @param line The line of the position.
+     * @param column The column of the position.
+     * @return The items covering the position. An empty list if none where found.
+     */
+    Items itemsAt(const long long int line, const long long int column) const;
+
+    /**
+     * @brief Check if some item is on the given line.
+     *
+     * @param line The line to check.
+     * @return True if the line holds an item, false otherwise.
+     */
+    bool hasItems(const long long int line) const;
+
+private:
+    PosRanges m_ranges;
+    // For each line, the [first, last) indexes of the top level ranges on it
+    QList<std::pair<qsizetype, qsizetype>> m_lines;
+};
+}
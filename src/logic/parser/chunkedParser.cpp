@@ -0,0 +1,342 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "chunkedParser.h"
+
+// KleverNotes include
+#include "incrementalParser.h"
+
+// Qt include
+#include <QSemaphore>
+#include <QSet>
+#include <QTextStream>
+#include <QThreadPool>
+
+// C++ include
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+// Notes with fewer lines are parsed on a single thread, cutting them costs more than it saves
+constexpr qsizetype MIN_LINES = 4000;
+// Smallest chunk worth its own thread
+constexpr qsizetype MIN_CHUNK_LINES = 1000;
+
+QStringView trimmedStart(const QStringView line)
+{
+    qsizetype i = 0;
+    while (i < line.size() && line.at(i).isSpace()) {
+        ++i;
+    }
+    return line.mid(i);
+}
+
+/**
+ * @brief Get the length of the list item marker starting the given line.
+ *
+ * @param line The line, without its indentation.
+ * @return The length of the marker, 0 if the line isn't a list item.
+ */
+qsizetype listMarkerLength(const QStringView line)
+{
+    if (line.isEmpty()) {
+        return 0;
+    }
+
+    qsizetype length = 0;
+    const QChar first = line.front();
+    if (first == QLatin1Char('-') || first == QLatin1Char('+') || first == QLatin1Char('*')) {
+        length = 1;
+    } else {
+        while (length < line.size() && length < 9 && line.at(length).isDigit()) {
+            ++length;
+        }
+        if (length == 0 || length == line.size() || (line.at(length) != QLatin1Char('.') && line.at(length) != QLatin1Char(')'))) {
+            return 0;
+        }
+        ++length;
+    }
+
+    return length == line.size() || line.at(length).isSpace() ? length : 0;
+}
+
+/**
+ * @brief Remove the indentation, blockquote and list markers opening the line, fences and HTML blocks can be nested in them.
+ *
+ * @param line The line.
+ * @return The content of the most nested block of the line.
+ */
+QStringView blockContent(QStringView line)
+{
+    while (true) {
+        line = trimmedStart(line);
+        if (line.startsWith(QLatin1Char('>'))) {
+            line = line.mid(1);
+            continue;
+        }
+
+        const qsizetype marker = listMarkerLength(line);
+        if (marker == 0) {
+            return line;
+        }
+        line = line.mid(marker);
+    }
+}
+
+/**
+ * @brief Get the length of the code fence starting the given content.
+ *
+ * @param content The content of the line.
+ * @param fenceChar Receive the character of the fence.
+ * @return The length of the fence, 0 if the content isn't a fence.
+ */
+qsizetype fenceLength(const QStringView content, QChar &fenceChar)
+{
+    if (content.isEmpty() || (content.front() != QLatin1Char('`') && content.front() != QLatin1Char('~'))) {
+        return 0;
+    }
+
+    qsizetype length = 0;
+    while (length < content.size() && content.at(length) == content.front()) {
+        ++length;
+    }
+    if (length < 3) {
+        return 0;
+    }
+
+    fenceChar = content.front();
+    return length;
+}
+
+/**
+ * @brief Get the text closing the HTML block started by the given content, for the HTML blocks that can hold blank lines.
+ *
+ * @param content The content of the line.
+ * @return The closing text, empty if no such block is left open by the line.
+ */
+QString htmlBlockEnd(const QStringView content)
+{
+    if (!content.startsWith(QLatin1Char('<'))) {
+        return {};
+    }
+
+    QString end;
+    const QStringView tag = content.mid(1);
+    for (const auto &rawTag : {QStringLiteral("script"), QStringLiteral("pre"), QStringLiteral("style"), QStringLiteral("textarea")}) {
+        if (tag.startsWith(rawTag, Qt::CaseInsensitive) && (tag.size() == rawTag.size() || tag.at(rawTag.size()).isSpace() || tag.at(rawTag.size()) == QLatin1Char('>'))) {
+            end = QStringLiteral("</") + rawTag + QLatin1Char('>');
+            break;
+        }
+    }
+
+    if (end.isEmpty()) {
+        if (tag.startsWith(QStringLiteral("!--"))) {
+            end = QStringLiteral("-->");
+        } else if (tag.startsWith(QLatin1Char('?'))) {
+            end = QStringLiteral("?>");
+        } else if (tag.startsWith(QStringLiteral("![CDATA["))) {
+            end = QStringLiteral("]]>");
+        } else if (tag.startsWith(QLatin1Char('!')) && 1 < tag.size() && tag.at(1).isLetter()) {
+            end = QStringLiteral(">");
+        } else {
+            return {};
+        }
+    }
+
+    // Closed on its opening line
+    return content.indexOf(end, 1, Qt::CaseInsensitive) == -1 ? end : QString();
+}
+
+/**
+ * @brief Check if the given line, following a blank line, starts a block that can't belong to the previous one.
+ *
+ * @param line The line.
+ * @return True if a chunk can start on the line, false otherwise.
+ */
+bool startsNewBlock(const QStringView line)
+{
+    // Indented lines continue lists, footnotes and indented code, list items join the list before the blank line
+    if (line.front().isSpace() || 0 < listMarkerLength(line)) {
+        return false;
+    }
+
+    // A chunk starting with a thematic break could be read as a YAML header
+    return !line.startsWith(QStringLiteral("---"));
+}
+
+bool isYamlDelimiter(const QStringView line)
+{
+    const QStringView trimmed = line.trimmed();
+    return trimmed == QStringLiteral("---") || trimmed == QStringLiteral("...");
+}
+}
+
+namespace chunkedParser
+{
+QList<qsizetype> chunkStarts(const MdEditor::TextSnapshot &snapshot, const qsizetype chunkCount)
+{
+    QList<qsizetype> starts = {0};
+    const qsizetype lineCount = snapshot.lineCount();
+    if (chunkCount < 2 || lineCount == 0) {
+        return starts;
+    }
+
+    const qsizetype chunkLines = lineCount / chunkCount;
+    qsizetype nextStart = chunkLines;
+
+    QChar fenceChar;
+    qsizetype fence = 0;
+    QString htmlEnd;
+    bool yaml = snapshot.line(0).trimmed() == QStringLiteral("---");
+    bool previousBlank = false;
+
+    for (qsizetype i = yaml ? 1 : 0; i < lineCount && starts.size() < chunkCount; ++i) {
+        const QStringView line = snapshot.line(i);
+
+        if (yaml) {
+            yaml = !isYamlDelimiter(line);
+            continue;
+        }
+
+        if (line.trimmed().isEmpty()) {
+            previousBlank = true;
+            continue;
+        }
+
+        // The last chunk is not left with a handful of lines
+        if (previousBlank && fence == 0 && htmlEnd.isEmpty() && nextStart <= i && i + chunkLines / 2 < lineCount && startsNewBlock(line)) {
+            starts.append(i);
+            nextStart = i + chunkLines;
+        }
+        previousBlank = false;
+
+        const QStringView content = blockContent(line);
+        if (fence != 0) {
+            QChar closingChar;
+            const qsizetype closing = fenceLength(content, closingChar);
+            if (closingChar == fenceChar && fence <= closing && content.mid(closing).trimmed().isEmpty()) {
+                fence = 0;
+            }
+        } else if (!htmlEnd.isEmpty()) {
+            if (line.contains(htmlEnd, Qt::CaseInsensitive)) {
+                htmlEnd.clear();
+            }
+        } else {
+            fence = fenceLength(content, fenceChar);
+            if (fence == 0) {
+                htmlEnd = htmlBlockEnd(content);
+            }
+        }
+    }
+
+    return starts;
+}
+
+QSharedPointer<MD::Document> parse(const MdEditor::TextSnapshot &snapshot,
+                                   const std::function<MD::Parser::InlineParsers()> &makeInlineParsers,
+                                   const QSharedPointer<parseCancellation::Generation> &generation,
+                                   const unsigned long long int parseCount,
+                                   const QString &path,
+                                   const QString &fileName)
+{
+    const qsizetype lineCount = snapshot.lineCount();
+    if (lineCount < MIN_LINES) {
+        return {};
+    }
+
+    auto *pool = QThreadPool::globalInstance();
+    // The current thread takes a chunk too, so even a single pooled thread helps
+    const qsizetype chunkCount = std::clamp<qsizetype>(pool->maxThreadCount() + 1, 2, lineCount / MIN_CHUNK_LINES);
+    const auto starts = chunkStarts(snapshot, chunkCount);
+    const qsizetype count = starts.size();
+    if (count < 2) {
+        return {};
+    }
+
+    // The md4qt parsers keep their state while parsing, each chunk gets its own
+    std::vector<MD::Parser::InlineParsers> inlineParsers;
+    inlineParsers.reserve(count);
+    for (qsizetype c = 0; c < count; ++c) {
+        inlineParsers.push_back(makeInlineParsers());
+    }
+
+    std::vector<QSharedPointer<MD::Document>> docs(count);
+    const auto parseChunk = [&](const qsizetype c) {
+        const parseCancellation::Scope cancellationScope(generation, parseCount);
+
+        const qsizetype lastLine = c + 1 < count ? starts.at(c + 1) - 1 : lineCount - 1;
+        QString md = snapshot.text(starts.at(c), lastLine);
+        QTextStream stream(&md, QIODeviceBase::ReadOnly);
+
+        MD::Parser parser;
+        parser.setInlineParsers(inlineParsers.at(c));
+        docs[c] = parser.parse(stream, path, fileName);
+    };
+
+    // The current thread parses the first chunk instead of waiting idle
+    QSemaphore finished;
+    for (qsizetype c = 1; c < count; ++c) {
+        pool->start([&parseChunk, &finished, c]() {
+            parseChunk(c);
+            finished.release();
+        });
+    }
+    parseChunk(0);
+    finished.acquire(count - 1);
+
+    if (parseCancellation::isCancelled() || docs.front()->items().isEmpty()) {
+        return {};
+    }
+
+    auto doc = QSharedPointer<MD::Document>::create();
+    doc->appendItem(docs.front()->items().at(0));
+
+    QSet<QString> labels;
+    for (qsizetype c = 0; c < count; ++c) {
+        const auto &chunkDoc = docs.at(c);
+
+        // Footnotes and reference links can be used from another chunk, only a full parsing resolves them
+        if (!chunkDoc->footnotesMap().isEmpty() || !chunkDoc->labeledLinks().isEmpty()) {
+            return {};
+        }
+
+        const auto &items = chunkDoc->items();
+        if (c < count - 1 && 1 < items.size() && incrementalParser::isOpenBlock(items.constLast().get())) {
+            return {};
+        }
+
+        // Headings sharing a label are numbered in order across the whole note
+        for (const auto &paths : chunkDoc->auxLabelsMap()) {
+            for (const auto &labelCount : paths) {
+                if (0 < labelCount) {
+                    return {};
+                }
+            }
+        }
+        const auto &chunkLabels = chunkDoc->labeledHeadings();
+        for (auto it = chunkLabels.cbegin(); it != chunkLabels.cend(); ++it) {
+            if (labels.contains(it.key())) {
+                return {};
+            }
+            labels.insert(it.key());
+            doc->insertLabeledHeading(it.key(), it.value());
+        }
+
+        const auto &auxLabels = chunkDoc->auxLabelsMap();
+        for (auto it = auxLabels.cbegin(); it != auxLabels.cend(); ++it) {
+            doc->auxLabelsMap().insert(it.key(), it.value());
+        }
+
+        for (qsizetype i = 1; i < items.size(); ++i) {
+            const auto &item = items.at(i);
+            incrementalParser::shiftLines(item.get(), starts.at(c));
+            doc->appendItem(item);
+        }
+    }
+
+    return doc;
+}
+}
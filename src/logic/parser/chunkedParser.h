@@ -0,0 +1,54 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#pragma once
+
+// KleverNotes include
+#include "parseCancellation.h"
+#include "textSnapshot.h"
+
+// md4qt include
+#include <md4qt/src/doc.h>
+#include <md4qt/src/parser.h>
+
+// Qt include
+#include <QList>
+#include <QString>
+
+// C++ include
+#include <functional>
+
+namespace chunkedParser
+{
+/**
+ * @brief Find where the note can be cut into independent chunks.
+ *
+ * A chunk starts after a blank line, outside of any fence, HTML block or YAML header,
+ * and on a line that can't continue the previous block (indented line, list item, ...).
+ *
+ * @param snapshot The lines of the note.
+ * @param chunkCount The wanted number of chunks.
+ * @return The first line of each chunk, starting with 0. There can be fewer chunks than wanted.
+ */
+QList<qsizetype> chunkStarts(const MdEditor::TextSnapshot &snapshot, const qsizetype chunkCount);
+
+/**
+ * @brief Parse a large note by cutting it into chunks parsed concurrently, the resulting documents are then stitched back together.
+ *
+ * @param snapshot The lines of the note.
+ * @param makeInlineParsers Create the inline parsers of a chunk, md4qt parsers can't be shared between threads.
+ * @param generation The parsing number of the newest text, each chunk can be aborted by a newer text.
+ * @param parseCount The parsing number of this text.
+ * @param path The directory in which the note is located.
+ * @param fileName The name of the note.
+ * @return The document, or a null pointer if the note is too small or can't be cut safely and a single-threaded parsing is required.
+ */
+QSharedPointer<MD::Document> parse(const MdEditor::TextSnapshot &snapshot,
+                                   const std::function<MD::Parser::InlineParsers()> &makeInlineParsers,
+                                   const QSharedPointer<parseCancellation::Generation> &generation,
+                                   const unsigned long long int parseCount,
+                                   const QString &path,
+                                   const QString &fileName);
+}
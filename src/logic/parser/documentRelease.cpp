@@ -0,0 +1,26 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "documentRelease.h"
+
+// Qt include
+#include <QThreadPool>
+
+namespace documentRelease
+{
+void releaseLater(QSharedPointer<MD::Document> doc)
+{
+    if (!doc) {
+        return;
+    }
+
+    // Behind the chunks of a parsing, which are waited for
+    QThreadPool::globalInstance()->start(
+        [doc = std::move(doc)]() mutable {
+            doc.reset();
+        },
+        -1);
+}
+}
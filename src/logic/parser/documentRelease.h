@@ -0,0 +1,26 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#pragma once
+
+// md4qt include
+#include <md4qt/src/doc.h>
+
+// Qt include
+#include <QSharedPointer>
+
+namespace documentRelease
+{
+/**
+ * @brief Drop a reference to a superseded document away from the calling thread.
+ *
+ * Each item of a document is its own allocation, freeing a large tree is a burst of small frees.
+ * If the given reference is the last one, the whole tree is freed at once on a pooled thread instead of the GUI thread.
+ * The items still shared with a newer document are left alive.
+ *
+ * @param doc The document, no longer used by the caller.
+ */
+void releaseLater(QSharedPointer<MD::Document> doc);
+}
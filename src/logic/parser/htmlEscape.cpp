@@ -0,0 +1,224 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "htmlEscape.h"
+
+// md4qt include
+#include <md4qt/src/entities_map.h>
+
+// C++ include
+#include <array>
+
+namespace
+{
+// Longer than the longest name of the md4qt entity map, `CounterClockwiseContourIntegral`
+constexpr qsizetype MAX_ENTITY_NAME = 32;
+
+// Replacement of each special character, indexed by its code, empty for the other ASCII characters
+const std::array<QStringView, 128> &escapeTable()
+{
+    static const std::array<QStringView, 128> table = []() {
+        std::array<QStringView, 128> result{};
+        result['&'] = u"&amp;";
+        result['<'] = u"&lt;";
+        result['>'] = u"&gt;";
+        result['"'] = u"&quot;";
+        result['\''] = u"&#39;";
+        return result;
+    }();
+    return table;
+}
+
+bool isAsciiAlphaNumeric(const char16_t c)
+{
+    return (u'a' <= c && c <= u'z') || (u'A' <= c && c <= u'Z') || (u'0' <= c && c <= u'9');
+}
+
+int digitValue(const char16_t c, const int base)
+{
+    if (u'0' <= c && c <= u'9') {
+        return c - u'0';
+    }
+    if (base == 16 && u'a' <= (c | 0x20) && (c | 0x20) <= u'f') {
+        return (c | 0x20) - u'a' + 10;
+    }
+    return -1;
+}
+
+/**
+ * @brief Check if an entity like `&amp;` or `&#39;` starts at the given `&`.
+ *
+ * @param text The text.
+ * @param pos The position of the `&`.
+ * @return True if the `&` starts an entity, false otherwise.
+ */
+bool startsEntity(QStringView text, qsizetype pos)
+{
+    ++pos;
+    if (pos < text.size() && text[pos] == u'#') {
+        ++pos;
+    }
+
+    const qsizetype nameStart = pos;
+    while (pos < text.size() && (isAsciiAlphaNumeric(text[pos].unicode()) || text[pos] == u'_')) {
+        ++pos;
+    }
+    return nameStart < pos && pos < text.size() && text[pos] == u';';
+}
+
+/**
+ * @struct Reference
+ * @brief A decoded character reference.
+ */
+struct Reference {
+    // Position after the reference, the position of its `&` if there is none
+    qsizetype end;
+    QString text;
+};
+
+/**
+ * @brief Decode the numeric reference starting at the given `&#`.
+ *
+ * @param html The HTML.
+ * @param pos The position of the `&`.
+ * @return The decoded reference.
+ */
+Reference decodeNumeric(QStringView html, const qsizetype pos)
+{
+    qsizetype digitsStart = pos + 2;
+    int base = 10;
+    if (digitsStart < html.size() && (html[digitsStart] == u'x' || html[digitsStart] == u'X')) {
+        base = 16;
+        ++digitsStart;
+    }
+
+    qsizetype end = digitsStart;
+    char32_t codePoint = 0;
+    for (int digit; end < html.size() && 0 <= (digit = digitValue(html[end].unicode(), base)); ++end) {
+        // Saturated, the reference is invalid anyway
+        if (codePoint <= 0x10FFFF) {
+            codePoint = codePoint * base + digit;
+        }
+    }
+    if (end == digitsStart) {
+        return {pos, {}};
+    }
+
+    if (codePoint == 0 || 0x10FFFF < codePoint || QChar::isSurrogate(codePoint)) {
+        codePoint = QChar::ReplacementCharacter;
+    }
+    return {end < html.size() && html[end] == u';' ? end + 1 : end, QString(QChar::fromUcs4(codePoint))};
+}
+
+/**
+ * @brief Decode the named reference starting at the given `&`.
+ *
+ * @param html The HTML.
+ * @param pos The position of the `&`.
+ * @return The decoded reference.
+ */
+Reference decodeNamed(QStringView html, const qsizetype pos)
+{
+    qsizetype end = pos + 1;
+    while (end < html.size() && end - pos <= MAX_ENTITY_NAME && isAsciiAlphaNumeric(html[end].unicode())) {
+        ++end;
+    }
+    if (end == pos + 1 || MAX_ENTITY_NAME < end - pos) {
+        return {pos, {}};
+    }
+
+    // The legacy references, like `&amp`, can omit the semicolon
+    if (end < html.size() && html[end] == u';') {
+        const auto it = MD::s_entityMap.constFind(html.mid(pos, end - pos + 1).toString());
+        if (it != MD::s_entityMap.cend()) {
+            return {end + 1, it.value()};
+        }
+    }
+    const auto it = MD::s_entityMap.constFind(html.mid(pos, end - pos).toString());
+    if (it != MD::s_entityMap.cend()) {
+        return {end, it.value()};
+    }
+    return {pos, {}};
+}
+}
+
+namespace htmlEscape
+{
+QString escape(const QString &text, const bool encode)
+{
+    const auto &table = escapeTable();
+    const QStringView view(text);
+
+    QString result;
+    qsizetype copied = 0;
+    for (qsizetype i = 0; i < view.size(); ++i) {
+        const char16_t c = view[i].unicode();
+        if (c >= table.size() || table[c].isEmpty() || (!encode && c == u'&' && startsEntity(view, i))) {
+            continue;
+        }
+
+        if (result.isNull()) {
+            // Most texts only have a few special characters
+            result.reserve(text.size() + text.size() / 8 + 8);
+        }
+        result.append(view.mid(copied, i - copied));
+        result.append(table[c]);
+        copied = i + 1;
+    }
+
+    if (result.isNull()) {
+        return text;
+    }
+    result.append(view.mid(copied));
+    return result;
+}
+
+void appendEscaped(QString &html, QStringView text)
+{
+    const auto &table = escapeTable();
+
+    qsizetype copied = 0;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        const char16_t c = text[i].unicode();
+        if (c >= table.size() || table[c].isEmpty()) {
+            continue;
+        }
+
+        html.append(text.mid(copied, i - copied));
+        html.append(table[c]);
+        copied = i + 1;
+    }
+    html.append(text.mid(copied));
+}
+
+QString unescape(const QString &html)
+{
+    const QStringView view(html);
+
+    QString result;
+    qsizetype copied = 0;
+    for (qsizetype pos = view.indexOf(u'&'); pos != -1; pos = view.indexOf(u'&', pos + 1)) {
+        const Reference reference = pos + 1 < view.size() && view[pos + 1] == u'#' ? decodeNumeric(view, pos) : decodeNamed(view, pos);
+        if (reference.end == pos) {
+            // Not a reference, the `&` is copied with the next run
+            continue;
+        }
+
+        if (result.isNull()) {
+            result.reserve(html.size());
+        }
+        result.append(view.mid(copied, pos - copied));
+        result.append(reference.text);
+        copied = reference.end;
+        pos = reference.end - 1;
+    }
+
+    if (result.isNull()) {
+        return html;
+    }
+    result.append(view.mid(copied));
+    return result;
+}
+}
@@ -0,0 +1,47 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#pragma once
+
+// Qt include
+#include <QString>
+
+/**
+ * Escaping of the text put in the HTML of the preview, shared by the renderer and its plugins.
+ *
+ * Both directions read the text once: the runs without special character are copied in bulk
+ * and the unchanged text is given back without any copy.
+ */
+namespace htmlEscape
+{
+/**
+ * @brief Escape the HTML special characters: `&`, `<`, `>`, `"` and `'`.
+ *
+ * @param text The text to escape.
+ * @param encode Whether every `&` is escaped. Otherwise, the ones starting an entity like `&amp;` or `&#39;` are kept.
+ * @return The escaped text.
+ */
+QString escape(const QString &text, const bool encode = true);
+
+/**
+ * @brief Escape the HTML special characters of the text, every `&` included, and append it to the HTML.
+ * Avoids a copy of the text when building an HTML piece by piece.
+ *
+ * @param html The HTML to append to.
+ * @param text The text to escape.
+ */
+void appendEscaped(QString &html, QStringView text);
+
+/**
+ * @brief Decode the character references of the given HTML.
+ *
+ * The named references are the ones known by md4qt, the unknown ones are kept as is.
+ * A numeric reference to an invalid code point gives U+FFFD.
+ *
+ * @param html The HTML to decode.
+ * @return The decoded text.
+ */
+QString unescape(const QString &html);
+}
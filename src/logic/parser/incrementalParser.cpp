@@ -0,0 +1,619 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "incrementalParser.h"
+
+// KleverNotes include
+#include "parseCancellation.h"
+#include "plugins/emoji/emojiPlugin.hpp"
+
+// Qt include
+#include <QSet>
+#include <QTextStream>
+
+// C++ include
+#include <algorithm>
+
+namespace MdEditor
+{
+TextEdit TextEdit::fullEdit()
+{
+    TextEdit edit;
+    edit.full = true;
+    return edit;
+}
+
+bool TextEdit::isEmpty() const
+{
+    return !full && firstLine == -1;
+}
+
+void TextEdit::merge(const TextEdit &next)
+{
+    if (full || next.full) {
+        full = true;
+        return;
+    }
+
+    if (next.isEmpty()) {
+        return;
+    }
+
+    if (isEmpty()) {
+        *this = next;
+        return;
+    }
+
+    // Bring the end of the next edit back into the coordinates of the text before this edit
+    const qsizetype lastAfterThis = lastLine + lineDelta;
+    const qsizetype nextLast = lastAfterThis < next.lastLine ? next.lastLine - lineDelta : lastLine;
+
+    firstLine = std::min(firstLine, next.firstLine);
+    lastLine = std::max(lastLine, nextLast);
+    lineDelta += next.lineDelta;
+}
+}
+
+namespace
+{
+/**
+ * @brief Move the lines of the given position by `delta`, leaving unset positions untouched.
+ *
+ * @param pos The position to move.
+ * @param delta The number of lines to add.
+ */
+void shiftPosition(MD::WithPosition &pos, const qsizetype delta)
+{
+    if (pos.startLine() != -1) {
+        pos.setStartLine(pos.startLine() + delta);
+    }
+    if (pos.endLine() != -1) {
+        pos.setEndLine(pos.endLine() + delta);
+    }
+}
+
+/**
+ * @brief Get a copy of the given position moved by `delta` lines.
+ *
+ * @param pos The position to copy.
+ * @param delta The number of lines to add.
+ * @return The moved position.
+ */
+MD::WithPosition shifted(const MD::WithPosition &pos, const qsizetype delta)
+{
+    MD::WithPosition result = pos;
+    shiftPosition(result, delta);
+    return result;
+}
+
+void shiftStyles(MD::ItemWithOpts *item, const qsizetype delta)
+{
+    for (auto &style : item->openStyles()) {
+        shiftPosition(style, delta);
+    }
+    for (auto &style : item->closeStyles()) {
+        shiftPosition(style, delta);
+    }
+}
+
+void shiftChildren(MD::Block *block, const qsizetype delta)
+{
+    for (const auto &child : block->items()) {
+        incrementalParser::shiftLines(child.get(), delta);
+    }
+}
+
+void shiftLinkBase(MD::LinkBase *link, const qsizetype delta)
+{
+    shiftStyles(link, delta);
+    link->setTextPos(shifted(link->textPos(), delta));
+    link->setUrlPos(shifted(link->urlPos(), delta));
+    if (link->p()) {
+        incrementalParser::shiftLines(link->p().get(), delta);
+    }
+}
+
+bool isIndented(const QStringView line)
+{
+    return !line.isEmpty() && line.front().isSpace();
+}
+
+/**
+ * @brief Add the labels of all the headings found inside the item to the document.
+ *
+ * @param doc The document receiving the labels.
+ * @param item The item in which we search for headings.
+ */
+void insertHeadingLabels(MD::Document *doc, const QSharedPointer<MD::Item> &item)
+{
+    switch (item->type()) {
+    case MD::ItemType::Heading: {
+        const auto heading = item.staticCast<MD::Heading>();
+        if (heading->isLabeled()) {
+            for (const auto &label : heading->labelVariants()) {
+                doc->insertLabeledHeading(label, heading);
+            }
+        }
+        break;
+    }
+    case MD::ItemType::Blockquote:
+    case MD::ItemType::List:
+    case MD::ItemType::ListItem: {
+        for (const auto &child : item.staticCast<MD::Block>()->items()) {
+            insertHeadingLabels(doc, child);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+bool samePosition(const MD::WithPosition &pos1, const MD::WithPosition &pos2)
+{
+    return pos1.startColumn() == pos2.startColumn() && pos1.startLine() == pos2.startLine() && pos1.endColumn() == pos2.endColumn()
+        && pos1.endLine() == pos2.endLine();
+}
+
+bool sameStyles(const MD::ItemWithOpts::Styles &styles1, const MD::ItemWithOpts::Styles &styles2)
+{
+    if (styles1.size() != styles2.size()) {
+        return false;
+    }
+    for (qsizetype i = 0; i < styles1.size(); ++i) {
+        if (styles1.at(i).style() != styles2.at(i).style() || !samePosition(styles1.at(i), styles2.at(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameItem(const MD::Item *item1, const MD::Item *item2);
+
+bool sameChildren(const MD::Block *block1, const MD::Block *block2)
+{
+    const auto &items1 = block1->items();
+    const auto &items2 = block2->items();
+    if (items1.size() != items2.size()) {
+        return false;
+    }
+    for (qsizetype i = 0; i < items1.size(); ++i) {
+        if (!sameItem(items1.at(i).get(), items2.at(i).get())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameItem(const MD::Item *item1, const MD::Item *item2)
+{
+    if (!item1 || !item2) {
+        return item1 == item2;
+    }
+
+    if (item1->type() != item2->type() || !samePosition(*item1, *item2)) {
+        return false;
+    }
+
+    switch (item1->type()) {
+    case MD::ItemType::Text:
+    case MD::ItemType::LineBreak: {
+        const auto text1 = static_cast<const MD::Text *>(item1);
+        const auto text2 = static_cast<const MD::Text *>(item2);
+        return text1->opts() == text2->opts() && text1->text() == text2->text() && sameStyles(text1->openStyles(), text2->openStyles())
+            && sameStyles(text1->closeStyles(), text2->closeStyles());
+    }
+    case MD::ItemType::Code:
+    case MD::ItemType::Math: {
+        const auto code1 = static_cast<const MD::Code *>(item1);
+        const auto code2 = static_cast<const MD::Code *>(item2);
+        return code1->text() == code2->text() && code1->syntax() == code2->syntax() && samePosition(code1->startDelim(), code2->startDelim())
+            && samePosition(code1->endDelim(), code2->endDelim()) && sameStyles(code1->openStyles(), code2->openStyles())
+            && sameStyles(code1->closeStyles(), code2->closeStyles());
+    }
+    case MD::ItemType::Link:
+    case MD::ItemType::Image: {
+        const auto link1 = static_cast<const MD::LinkBase *>(item1);
+        const auto link2 = static_cast<const MD::LinkBase *>(item2);
+        return link1->url() == link2->url() && link1->text() == link2->text() && samePosition(link1->urlPos(), link2->urlPos())
+            && samePosition(link1->textPos(), link2->textPos()) && sameStyles(link1->openStyles(), link2->openStyles())
+            && sameStyles(link1->closeStyles(), link2->closeStyles());
+    }
+    case MD::ItemType::Heading: {
+        const auto heading1 = static_cast<const MD::Heading *>(item1);
+        const auto heading2 = static_cast<const MD::Heading *>(item2);
+        return heading1->level() == heading2->level() && heading1->label() == heading2->label()
+            && sameItem(heading1->text().get(), heading2->text().get());
+    }
+    case MD::ItemType::ListItem: {
+        const auto listItem1 = static_cast<const MD::ListItem *>(item1);
+        const auto listItem2 = static_cast<const MD::ListItem *>(item2);
+        return listItem1->listType() == listItem2->listType() && listItem1->isChecked() == listItem2->isChecked()
+            && samePosition(listItem1->delim(), listItem2->delim()) && sameChildren(listItem1, listItem2);
+    }
+    case MD::ItemType::Table: {
+        const auto &rows1 = static_cast<const MD::Table *>(item1)->rows();
+        const auto &rows2 = static_cast<const MD::Table *>(item2)->rows();
+        if (rows1.size() != rows2.size()) {
+            return false;
+        }
+        for (qsizetype i = 0; i < rows1.size(); ++i) {
+            if (!sameItem(rows1.at(i).get(), rows2.at(i).get())) {
+                return false;
+            }
+        }
+        return true;
+    }
+    case MD::ItemType::TableRow: {
+        const auto &cells1 = static_cast<const MD::TableRow *>(item1)->cells();
+        const auto &cells2 = static_cast<const MD::TableRow *>(item2)->cells();
+        if (cells1.size() != cells2.size()) {
+            return false;
+        }
+        for (qsizetype i = 0; i < cells1.size(); ++i) {
+            if (!sameItem(cells1.at(i).get(), cells2.at(i).get())) {
+                return false;
+            }
+        }
+        return true;
+    }
+    case MD::ItemType::Paragraph:
+    case MD::ItemType::Blockquote:
+    case MD::ItemType::List:
+    case MD::ItemType::TableCell:
+    case MD::ItemType::Footnote:
+    case MD::ItemType::Document:
+        return sameChildren(static_cast<const MD::Block *>(item1), static_cast<const MD::Block *>(item2));
+    default: {
+        const auto emoji1 = dynamic_cast<const EmojiPlugin::EmojiItem *>(item1);
+        const auto emoji2 = dynamic_cast<const EmojiPlugin::EmojiItem *>(item2);
+        if (emoji1 && emoji2) {
+            return emoji1->emoji() == emoji2->emoji() && samePosition(emoji1->emojiNamePos(), emoji2->emojiNamePos())
+                && samePosition(emoji1->optionsPos(), emoji2->optionsPos()) && sameStyles(emoji1->openStyles(), emoji2->openStyles())
+                && sameStyles(emoji1->closeStyles(), emoji2->closeStyles());
+        }
+        return true;
+    }
+    }
+}
+}
+
+namespace incrementalParser
+{
+void shiftLines(MD::Item *item, const qsizetype delta)
+{
+    if (!item || delta == 0) {
+        return;
+    }
+
+    shiftPosition(*item, delta);
+
+    switch (item->type()) {
+    case MD::ItemType::Heading: {
+        const auto heading = static_cast<MD::Heading *>(item);
+        if (heading->text()) {
+            shiftLines(heading->text().get(), delta);
+        }
+        auto delims = heading->delims();
+        for (auto &delim : delims) {
+            shiftPosition(delim, delta);
+        }
+        heading->setDelims(delims);
+        heading->setLabelPos(shifted(heading->labelPos(), delta));
+        break;
+    }
+    case MD::ItemType::Text:
+    case MD::ItemType::LineBreak:
+    case MD::ItemType::RawHtml: {
+        shiftStyles(static_cast<MD::ItemWithOpts *>(item), delta);
+        break;
+    }
+    case MD::ItemType::FootnoteRef: {
+        const auto ref = static_cast<MD::FootnoteRef *>(item);
+        shiftStyles(ref, delta);
+        ref->setIdPos(shifted(ref->idPos(), delta));
+        break;
+    }
+    case MD::ItemType::Code:
+    case MD::ItemType::Math: {
+        const auto code = static_cast<MD::Code *>(item);
+        shiftStyles(code, delta);
+        code->setSyntaxPos(shifted(code->syntaxPos(), delta));
+        code->setStartDelim(shifted(code->startDelim(), delta));
+        code->setEndDelim(shifted(code->endDelim(), delta));
+        break;
+    }
+    case MD::ItemType::Link: {
+        const auto link = static_cast<MD::Link *>(item);
+        shiftLinkBase(link, delta);
+        if (link->img()) {
+            shiftLines(link->img().get(), delta);
+        }
+        break;
+    }
+    case MD::ItemType::Image: {
+        shiftLinkBase(static_cast<MD::Image *>(item), delta);
+        break;
+    }
+    case MD::ItemType::Blockquote: {
+        const auto quote = static_cast<MD::Blockquote *>(item);
+        for (auto &delim : quote->delims()) {
+            shiftPosition(delim, delta);
+        }
+        shiftChildren(quote, delta);
+        break;
+    }
+    case MD::ItemType::ListItem: {
+        const auto listItem = static_cast<MD::ListItem *>(item);
+        listItem->setDelim(shifted(listItem->delim(), delta));
+        listItem->setTaskDelim(shifted(listItem->taskDelim(), delta));
+        shiftChildren(listItem, delta);
+        break;
+    }
+    case MD::ItemType::Footnote: {
+        const auto footnote = static_cast<MD::Footnote *>(item);
+        footnote->setIdPos(shifted(footnote->idPos(), delta));
+        shiftChildren(footnote, delta);
+        break;
+    }
+    case MD::ItemType::Paragraph:
+    case MD::ItemType::List:
+    case MD::ItemType::TableCell:
+    case MD::ItemType::Document: {
+        shiftChildren(static_cast<MD::Block *>(item), delta);
+        break;
+    }
+    case MD::ItemType::Table: {
+        for (const auto &row : static_cast<MD::Table *>(item)->rows()) {
+            shiftLines(row.get(), delta);
+        }
+        break;
+    }
+    case MD::ItemType::TableRow: {
+        for (const auto &cell : static_cast<MD::TableRow *>(item)->cells()) {
+            shiftLines(cell.get(), delta);
+        }
+        break;
+    }
+    default: {
+        // The YAML header shares its type with the emoji, but it is always the first block and never moved
+        const auto emoji = dynamic_cast<EmojiPlugin::EmojiItem *>(item);
+        if (emoji) {
+            shiftStyles(emoji, delta);
+            emoji->setEmojiNamePos(shifted(emoji->emojiNamePos(), delta));
+            emoji->setOptionsPos(shifted(emoji->optionsPos(), delta));
+            emoji->setStartDelim(shifted(emoji->startDelim(), delta));
+            emoji->setEndDelim(shifted(emoji->endDelim(), delta));
+        }
+        break;
+    }
+    }
+}
+
+bool isOpenBlock(const MD::Item *item)
+{
+    switch (item->type()) {
+    case MD::ItemType::Code: {
+        const auto code = static_cast<const MD::Code *>(item);
+        return code->isFensedCode() && code->endDelim().startColumn() == -1;
+    }
+    case MD::ItemType::RawHtml:
+        return true;
+    default:
+        return false;
+    }
+}
+
+QSharedPointer<MD::Document> reparse(MD::Parser &parser,
+                                     const QSharedPointer<MD::Document> &previousDoc,
+                                     const MdEditor::TextSnapshot &snapshot,
+                                     const MdEditor::TextEdit &edit,
+                                     const QString &path,
+                                     const QString &fileName)
+{
+    if (!previousDoc || edit.isEmpty() || edit.full) {
+        return {};
+    }
+
+    // Footnotes and reference links are resolved across the whole note, we can't reparse them locally
+    if (!previousDoc->footnotesMap().isEmpty() || !previousDoc->labeledLinks().isEmpty()) {
+        return {};
+    }
+
+    const auto &items = previousDoc->items();
+    const qsizetype count = items.size();
+    // The first item is always the anchor of the note
+    if (count < 2) {
+        return {};
+    }
+
+    const qsizetype lineCount = snapshot.lineCount();
+    const qsizetype previousLineCount = lineCount - edit.lineDelta;
+
+    qsizetype first = 1;
+    while (first < count && items.at(first)->endLine() < edit.firstLine) {
+        ++first;
+    }
+    qsizetype last = count - 1;
+    while (1 <= last && edit.lastLine < items.at(last)->startLine()) {
+        --last;
+    }
+
+    // The untouched neighbours could be merged with the edited blocks (lazy continuation, setext heading, ...), reparse them too
+    first = std::max<qsizetype>(1, std::min(first, last) - 1);
+    last = std::min(count - 1, std::max(first, last) + 1);
+
+    // Grow the region until it is surrounded by blank lines and by blocks that can't be continued by it
+    bool grown = true;
+    while (grown) {
+        grown = false;
+
+        if (1 < first) {
+            const auto &previous = items.at(first - 1);
+            const bool blankGap = previous->endLine() + 1 < items.at(first)->startLine();
+            const bool continuable = previous->type() == MD::ItemType::List || previous->type() == MD::ItemType::Footnote;
+            if (!blankGap || continuable) {
+                --first;
+                grown = true;
+            }
+        }
+
+        if (last < count - 1) {
+            const auto &next = items.at(last + 1);
+            const bool blankGap = items.at(last)->endLine() + 1 < next->startLine();
+            const qsizetype nextLine = next->startLine() + edit.lineDelta;
+            const bool indented = nextLine < 0 || lineCount <= nextLine || isIndented(snapshot.line(nextLine));
+            if (!blankGap || indented) {
+                ++last;
+                grown = true;
+            }
+        }
+    }
+
+    const qsizetype regionStart = 1 < first ? items.at(first - 1)->endLine() + 1 : 0;
+    const qsizetype previousRegionEnd = last < count - 1 ? items.at(last + 1)->startLine() - 1 : previousLineCount - 1;
+    const qsizetype regionEnd = previousRegionEnd + edit.lineDelta;
+
+    if (edit.firstLine < regionStart || previousRegionEnd < edit.lastLine || regionEnd < regionStart || lineCount <= regionEnd) {
+        return {};
+    }
+
+    QString regionMd = snapshot.text(regionStart, regionEnd);
+
+    QTextStream stream(&regionMd, QIODeviceBase::ReadOnly);
+    const auto regionDoc = parser.parse(stream, path, fileName);
+
+    if (parseCancellation::isCancelled()) {
+        return {};
+    }
+
+    if (!regionDoc->footnotesMap().isEmpty() || !regionDoc->labeledLinks().isEmpty()) {
+        return {};
+    }
+
+    const auto &regionItems = regionDoc->items();
+    if (1 < regionItems.size()) {
+        const auto &regionFirst = regionItems.at(1);
+        const auto &regionLast = regionItems.constLast();
+
+        // A YAML header is only valid at the very start of the note
+        if (0 < regionStart && regionFirst->type() == MD::ItemType{static_cast<int>(MD::ItemType::UserDefined) + 1}
+            && !dynamic_cast<EmojiPlugin::EmojiItem *>(regionFirst.get())) {
+            return {};
+        }
+
+        if (last < count - 1) {
+            const auto &next = items.at(last + 1);
+            if (isOpenBlock(regionLast.get()) || (regionLast->type() == MD::ItemType::List && next->type() == MD::ItemType::List)) {
+                return {};
+            }
+        }
+
+        if (1 < first && regionFirst->type() == MD::ItemType::List && items.at(first - 1)->type() == MD::ItemType::List) {
+            return {};
+        }
+    }
+
+    // Headings sharing a label are numbered in order, only splice if no label collides
+    QSet<QString> keptLabels;
+    bool regionHadHeadings = false;
+    const auto &previousLabels = previousDoc->labeledHeadings();
+    for (auto it = previousLabels.cbegin(); it != previousLabels.cend(); ++it) {
+        const auto line = it.value()->startLine();
+        if (regionStart <= line && line <= previousRegionEnd) {
+            regionHadHeadings = true;
+        } else {
+            keptLabels.insert(it.key());
+        }
+    }
+
+    const auto &regionLabels = regionDoc->labeledHeadings();
+    if (regionHadHeadings || !regionLabels.isEmpty()) {
+        const auto hasDuplicates = [](const MD::Document::AuxLabelsMap &auxLabels) {
+            for (const auto &paths : auxLabels) {
+                for (const auto &labelCount : paths) {
+                    if (0 < labelCount) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        };
+
+        if (hasDuplicates(previousDoc->auxLabelsMap()) || hasDuplicates(regionDoc->auxLabelsMap())) {
+            return {};
+        }
+        for (auto it = regionLabels.cbegin(); it != regionLabels.cend(); ++it) {
+            if (keptLabels.contains(it.key())) {
+                return {};
+            }
+        }
+    }
+
+    auto doc = QSharedPointer<MD::Document>::create();
+    doc->appendItem(items.at(0));
+
+    // Untouched blocks before the region keep their positions, they can be shared with the previous document
+    for (qsizetype i = 1; i < first; ++i) {
+        doc->appendItem(items.at(i));
+    }
+
+    for (qsizetype i = 1; i < regionItems.size(); ++i) {
+        const auto &item = regionItems.at(i);
+        shiftLines(item.get(), regionStart);
+        doc->appendItem(item);
+    }
+
+    // The previous document may still be in use by the GUI thread, the moved blocks must be copies
+    for (qsizetype i = last + 1; i < count; ++i) {
+        if (parseCancellation::isCancelled()) {
+            return {};
+        }
+
+        const auto &item = items.at(i);
+        if (edit.lineDelta == 0) {
+            doc->appendItem(item);
+        } else {
+            const auto copy = item->clone();
+            shiftLines(copy.get(), edit.lineDelta);
+            doc->appendItem(copy);
+        }
+    }
+
+    for (qsizetype i = 1; i < doc->items().size(); ++i) {
+        insertHeadingLabels(doc.get(), doc->items().at(i));
+    }
+
+    doc->auxLabelsMap() = previousDoc->auxLabelsMap();
+    const auto &regionAuxLabels = regionDoc->auxLabelsMap();
+    for (auto it = regionAuxLabels.cbegin(); it != regionAuxLabels.cend(); ++it) {
+        doc->auxLabelsMap().insert(it.key(), it.value());
+    }
+
+    return doc;
+}
+
+bool sameDocument(const QSharedPointer<MD::Document> &doc1, const QSharedPointer<MD::Document> &doc2)
+{
+    if (!doc1 || !doc2) {
+        return doc1 == doc2;
+    }
+
+    const auto &items1 = doc1->items();
+    const auto &items2 = doc2->items();
+    if (items1.size() != items2.size()) {
+        return false;
+    }
+
+    // Skip the anchor, its positions are never set
+    for (qsizetype i = 1; i < items1.size(); ++i) {
+        if (!sameItem(items1.at(i).get(), items2.at(i).get())) {
+            return false;
+        }
+    }
+
+    return doc1->labeledHeadings().keys() == doc2->labeledHeadings().keys();
+}
+}
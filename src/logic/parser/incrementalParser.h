@@ -0,0 +1,110 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#pragma once
+
+// Qt include
+#include <QMetaType>
+#include <QString>
+
+// KleverNotes include
+#include "textSnapshot.h"
+
+// md4qt include
+#include <md4qt/src/doc.h>
+#include <md4qt/src/parser.h>
+
+namespace MdEditor
+{
+/**
+ * @class TextEdit
+ * @brief Lines of the note touched by one or more edits since the last parsing.
+ *
+ * The lines are expressed in the coordinates of the text that was last parsed.
+ */
+struct TextEdit {
+    // First touched line, identical before and after the edit.
+    qsizetype firstLine = -1;
+    // Last touched line, before the edit.
+    qsizetype lastLine = -1;
+    // Number of lines added (positive) or removed (negative) by the edit.
+    qsizetype lineDelta = 0;
+    // Whether the whole note must be parsed again.
+    bool full = false;
+
+    /**
+     * @brief Create an edit asking for a full parsing of the note.
+     *
+     * @return A TextEdit covering the whole note.
+     */
+    static TextEdit fullEdit();
+
+    /**
+     * @brief Check if nothing has been edited.
+     *
+     * @return True if no line has been touched, false otherwise.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Merge an edit that happened after this one into it.
+     *
+     * @param next The edit following this one, expressed in the coordinates of the text resulting from this one.
+     */
+    void merge(const TextEdit &next);
+};
+}
+
+Q_DECLARE_METATYPE(MdEditor::TextEdit)
+
+namespace incrementalParser
+{
+/**
+ * @brief Parse again only the top-level blocks touched by the edit and splice them into the previous document.
+ *
+ * The reparsed region is expanded to the closest blank lines separating two untouched top-level blocks,
+ * so that fences, lists and blockquotes are never cut in half.
+ *
+ * @param parser The md4qt parser used for the region.
+ * @param previousDoc The document resulting of the previous parsing.
+ * @param snapshot The lines of the markdown text after the edit.
+ * @param edit The lines touched since the previous parsing.
+ * @param path The directory in which the note is located.
+ * @param fileName The name of the note.
+ * @return The new document, or a null pointer if the edit can't be handled incrementally and a full parsing is required.
+ */
+QSharedPointer<MD::Document> reparse(MD::Parser &parser,
+                                     const QSharedPointer<MD::Document> &previousDoc,
+                                     const MdEditor::TextSnapshot &snapshot,
+                                     const MdEditor::TextEdit &edit,
+                                     const QString &path,
+                                     const QString &fileName);
+
+/**
+ * @brief Move the given item, and all its children, by the given number of lines.
+ *
+ * @param item The item to move.
+ * @param delta The number of lines to add to every position of the item.
+ */
+void shiftLines(MD::Item *item, const qsizetype delta);
+
+/**
+ * @brief Check if the given item is a top-level block that could swallow the block following it.
+ *
+ * @param item The last item of a parsed region.
+ * @return True if the item is left open (unclosed fence, raw HTML), false otherwise.
+ */
+bool isOpenBlock(const MD::Item *item);
+
+/**
+ * @brief Check that both documents hold the same items at the same positions.
+ * Used to verify the incremental parsing against a full parsing.
+ *
+ * @param doc1 A document.
+ * @param doc2 Another document.
+ * @return True if both documents are equivalent, false otherwise.
+ */
+bool sameDocument(const QSharedPointer<MD::Document> &doc1, const QSharedPointer<MD::Document> &doc2);
+}
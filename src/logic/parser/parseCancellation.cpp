@@ -0,0 +1,35 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "parseCancellation.h"
+
+namespace
+{
+// The md4qt plugins have no access to the Parser, they find the current parsing through its thread
+thread_local const parseCancellation::Generation *currentGeneration = nullptr;
+thread_local unsigned long long int currentParseCount = 0;
+}
+
+namespace parseCancellation
+{
+Scope::Scope(const QSharedPointer<Generation> &generation, const unsigned long long int parseCount)
+    : m_previousGeneration(currentGeneration)
+    , m_previousParseCount(currentParseCount)
+{
+    currentGeneration = generation.get();
+    currentParseCount = parseCount;
+}
+
+Scope::~Scope()
+{
+    currentGeneration = m_previousGeneration;
+    currentParseCount = m_previousParseCount;
+}
+
+bool isCancelled()
+{
+    return currentGeneration && currentGeneration->load(std::memory_order_relaxed) != currentParseCount;
+}
+}
@@ -0,0 +1,48 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#pragma once
+
+// Qt include
+#include <QSharedPointer>
+
+// C++ include
+#include <atomic>
+
+namespace parseCancellation
+{
+/**
+ * @brief Parsing number of the newest text of the editor.
+ * Written by the GUI thread each time the text changes, read by the parsing thread.
+ */
+using Generation = std::atomic<unsigned long long int>;
+
+/**
+ * @class Scope
+ * @brief Make the given parsing cancellable for the current thread, for the lifetime of the scope.
+ *
+ * The parsing is cancelled as soon as the generation no longer matches its parsing number.
+ */
+class Scope
+{
+public:
+    Scope(const QSharedPointer<Generation> &generation, const unsigned long long int parseCount);
+    ~Scope();
+
+    Q_DISABLE_COPY(Scope)
+
+private:
+    const Generation *m_previousGeneration = nullptr;
+    unsigned long long int m_previousParseCount = 0;
+};
+
+/**
+ * @brief Check if the parsing running on the current thread has been superseded by a newer text.
+ * Meant to be checked at block boundaries, it is always false outside of a Scope.
+ *
+ * @return True if the parsing should be aborted, false otherwise.
+ */
+bool isCancelled();
+}
@@ -6,17 +6,26 @@
 #include "parser.h"
 
 #include "extendedSyntax/extendedSyntaxMaker.hpp"
+#include "logic/editor/editorTrace.hpp"
 
 #include "kleverconfig.h"
 
+#include <QDebug>
+
 namespace MdEditor
 {
 Parser::Parser()
+    : m_verifyIncremental(qEnvironmentVariableIsSet("KLEVERNOTES_VERIFY_INCREMENTAL_PARSING"))
 {
     connect(this, &Parser::newData, this, &Parser::onParse, Qt::QueuedConnection);
     connectPlugins();
 }
 
+void Parser::setGeneration(const QSharedPointer<parseCancellation::Generation> &generation)
+{
+    m_generation = generation;
+}
+
 // Connections
 // ===========
 void Parser::connectPlugins()
@@ -30,9 +39,43 @@ void Parser::connectPlugins()
     connect(KleverConfig::self(), &KleverConfig::quickEmojiEnabledChanged, this, qOverload<>(&Parser::quickEmojiEnabledChanged), Qt::DirectConnection);
     connect(this, &Parser::quickEmojiEnabledChangedSignal, this, qOverload<bool>(&Parser::quickEmojiEnabledChanged), Qt::QueuedConnection);
     quickEmojiEnabledChanged();
+
+    connect(KleverConfig::self(), &KleverConfig::emojiToneChanged, this, qOverload<>(&Parser::emojiToneChanged), Qt::DirectConnection);
+    connect(this, &Parser::emojiToneChangedSignal, this, qOverload<const QString &>(&Parser::emojiToneChanged), Qt::QueuedConnection);
+    emojiToneChanged();
+
+    connect(KleverConfig::self(), &KleverConfig::storagePathChanged, this, qOverload<>(&Parser::storagePathChanged), Qt::DirectConnection);
+    connect(this, &Parser::storagePathChangedSignal, this, qOverload<const QString &>(&Parser::storagePathChanged), Qt::QueuedConnection);
+    storagePathChanged();
 }
 // !Connections
 
+// Getters
+// =======
+MD::Parser::InlineParsers Parser::makeInlineParsers() const
+{
+    auto inlineParsers =
+        setInlineParsers<ExtendedSyntaxMaker::SupEmphasisParser, ExtendedSyntaxMaker::SubEmphasisParser, ExtendedSyntaxMaker::HighlightEmphasisParser>();
+
+    for (const auto &id : std::as_const(m_plugins)) {
+        switch (id) {
+        case PluginID::EmojiPlugin: {
+            MD::Parser::appendInlineParser<EmojiPlugin::EmojiParser>(inlineParsers)->setConfigTone(m_emojiTone);
+        } break;
+
+        case PluginID::NoteLinkingPlugin: {
+            MD::Parser::appendInlineParser<NoteLinkingPlugin::NoteLinkingParser>(inlineParsers)->setStoragePath(m_storagePath);
+        } break;
+
+        default:
+            break;
+        }
+    }
+
+    return inlineParsers;
+}
+// !Getters
+
 // KleverNotes slots
 // =================
 void Parser::noteLinkingEnabledChanged()
@@ -45,6 +88,16 @@ void Parser::quickEmojiEnabledChanged()
     Q_EMIT quickEmojiEnabledChangedSignal(KleverConfig::quickEmojiEnabled());
 }
 
+void Parser::emojiToneChanged()
+{
+    Q_EMIT emojiToneChangedSignal(KleverConfig::emojiTone());
+}
+
+void Parser::storagePathChanged()
+{
+    Q_EMIT storagePathChangedSignal(KleverConfig::storagePath());
+}
+
 void Parser::noteLinkingEnabledChanged(bool on)
 {
     addRemovePlugin<NoteLinkingPlugin::NoteLinkingParser>(on);
@@ -54,13 +107,33 @@ void Parser::quickEmojiEnabledChanged(bool on)
 {
     addRemovePlugin<EmojiPlugin::EmojiParser>(on);
 }
+
+void Parser::emojiToneChanged(const QString &tone)
+{
+    m_emojiTone = tone;
+    m_md4qtParser.setInlineParsers(makeInlineParsers());
+    // The previous blocks were parsed with another tone
+    m_previousDoc.reset();
+}
+
+void Parser::storagePathChanged(const QString &storagePath)
+{
+    m_storagePath = storagePath;
+    m_md4qtParser.setInlineParsers(makeInlineParsers());
+    // The previous blocks were parsed with another storage path
+    m_previousDoc.reset();
+}
 // !KleverNotes slots
 
 // markdown-tools editor slots
-void Parser::onData(const QString &md, const QString &noteDir, const QString &noteName, unsigned long long int counter)
+void Parser::onData(const MdEditor::TextSnapshot &snapshot, const QString &noteDir, const QString &noteName, const MdEditor::TextEdit &edit, unsigned long long int counter)
 {
     m_data.clear();
-    m_data.push_back(md);
+    m_data.push_back(snapshot);
+    if (noteDir != m_noteDir || noteName != m_noteName) {
+        m_pendingEdit = TextEdit::fullEdit();
+    }
+    m_pendingEdit.merge(edit);
     m_noteDir = noteDir;
     m_noteName = noteName;
     m_counter = counter;
@@ -71,11 +144,75 @@ void Parser::onData(const QString &md, const QString &noteDir, const QString &no
 void Parser::onParse()
 {
     if (!m_data.isEmpty()) {
-        QTextStream stream(&m_data.back());
-
-        const auto doc = m_md4qtParser.parse(stream, m_noteDir, m_noteName);
+        const parseCancellation::Scope cancellationScope(m_generation, m_counter);
+        const editorTrace::Span span("parse", m_counter);
+
+        // The pending edit is kept, the next data will merge its own edit into it
+        const auto cancel = [this]() {
+            m_data.clear();
+            Q_EMIT done(nullptr, m_counter);
+        };
+
+        QSharedPointer<MD::Document> doc;
+        {
+            const editorTrace::Span incrementalSpan("incrementalParse", m_counter);
+            doc = incrementalParser::reparse(m_md4qtParser, m_previousDoc, m_data.back(), m_pendingEdit, m_noteDir, m_noteName);
+        }
+
+        if (!doc || m_verifyIncremental) {
+            if (parseCancellation::isCancelled()) {
+                cancel();
+                return;
+            }
+
+            // Large notes are cut into chunks parsed on several threads
+            QSharedPointer<MD::Document> fullDoc;
+            {
+                const editorTrace::Span chunkedSpan("chunkedParse", m_counter);
+                fullDoc = chunkedParser::parse(
+                    m_data.back(),
+                    [this]() {
+                        return makeInlineParsers();
+                    },
+                    m_generation,
+                    m_counter,
+                    m_noteDir,
+                    m_noteName);
+            }
+            if (parseCancellation::isCancelled()) {
+                cancel();
+                return;
+            }
+
+            if (!fullDoc || m_verifyIncremental) {
+                // md4qt needs the whole text at once
+                const editorTrace::Span fullSpan("fullParse", m_counter);
+                QString md = m_data.back().toString();
+                QTextStream stream(&md, QIODeviceBase::ReadOnly);
+                const auto singleDoc = m_md4qtParser.parse(stream, m_noteDir, m_noteName);
+
+                if (fullDoc && !incrementalParser::sameDocument(fullDoc, singleDoc)) {
+                    qWarning() << "Chunked parsing differs from full parsing";
+                }
+                fullDoc = singleDoc;
+            }
+
+            if (doc && !incrementalParser::sameDocument(doc, fullDoc)) {
+                qWarning() << "Incremental parsing differs from full parsing, lines" << m_pendingEdit.firstLine << "to" << m_pendingEdit.lastLine
+                           << "delta" << m_pendingEdit.lineDelta;
+            }
+            doc = fullDoc;
+        }
+
+        // The plugins stopped their work, the document is incomplete
+        if (parseCancellation::isCancelled()) {
+            cancel();
+            return;
+        }
 
         m_data.clear();
+        m_pendingEdit = TextEdit();
+        m_previousDoc = doc;
 
         Q_EMIT done(doc, m_counter);
     }
@@ -10,7 +10,10 @@
 #include <QSet>
 
 // KleverNotes include
+#include "chunkedParser.h"
 #include "extendedSyntax/extendedSyntaxMaker.hpp"
+#include "incrementalParser.h"
+#include "parseCancellation.h"
 #include "plugins/emoji/emojiPlugin.hpp"
 #include "plugins/noteMapper/noteLinkingPlugin.hpp"
 #include "plugins_helper.h"
@@ -34,6 +37,14 @@ class Parser : public QObject
 public:
     explicit Parser();
 
+    /**
+     * @brief Set the generation used to abort the parsing of an outdated text.
+     * Must be called before the parser is moved to its thread.
+     *
+     * @param generation The parsing number of the newest text, updated by the editor.
+     */
+    void setGeneration(const QSharedPointer<parseCancellation::Generation> &generation);
+
 private:
     // Connections
     /**
@@ -41,6 +52,14 @@ private:
      */
     void connectPlugins();
 
+    // Getters
+    /**
+     * @brief Create the inline parsers matching the enabled plugins.
+     *
+     * @return A new set of inline parsers, not shared with any md4qt parser.
+     */
+    MD::Parser::InlineParsers makeInlineParsers() const;
+
     // Setters
     /**
      * @brief Add/remove a specific plugin.
@@ -50,9 +69,6 @@ private:
     template<class Plugin>
     void addRemovePlugin(const bool add)
     {
-        auto inlineParsers =
-            setInlineParsers<ExtendedSyntaxMaker::SupEmphasisParser, ExtendedSyntaxMaker::SubEmphasisParser, ExtendedSyntaxMaker::HighlightEmphasisParser>();
-
         if (add) {
             if (std::is_same<Plugin, EmojiPlugin::EmojiParser>::value) {
                 m_plugins.insert(PluginID::EmojiPlugin);
@@ -67,22 +83,9 @@ private:
             }
         }
 
-        for (const auto &id : std::as_const(m_plugins)) {
-            switch (id) {
-            case PluginID::EmojiPlugin: {
-                addInlinePlugins<EmojiPlugin::EmojiParser>(inlineParsers);
-            } break;
-
-            case PluginID::NoteLinkingPlugin: {
-                addInlinePlugins<NoteLinkingPlugin::NoteLinkingParser>(inlineParsers);
-            } break;
-
-            default:
-                break;
-            }
-        }
-
-        m_md4qtParser.setInlineParsers(inlineParsers);
+        m_md4qtParser.setInlineParsers(makeInlineParsers());
+        // The previous blocks were parsed with another set of plugins
+        m_previousDoc.reset();
     }
 
 Q_SIGNALS:
@@ -94,7 +97,7 @@ Q_SIGNALS:
     /**
      * @brief The parsing is finished.
      *
-     * @param mdDoc The resulting MD::Document.
+     * @param mdDoc The resulting MD::Document, null if the parsing was cancelled by a newer text.
      * @param parseCount The parsing number related to this MD::Document. Used for multithreading.
      */
     void done(QSharedPointer<MD::Document> mdDoc, unsigned long long int parseCount);
@@ -113,17 +116,32 @@ Q_SIGNALS:
      */
     void quickEmojiEnabledChangedSignal(bool on);
 
+    /**
+     * @brief Emoji default tone changed.
+     *
+     * @param tone The new default tone.
+     */
+    void emojiToneChangedSignal(const QString &tone);
+
+    /**
+     * @brief Storage path changed.
+     *
+     * @param storagePath The new storage path.
+     */
+    void storagePathChangedSignal(const QString &storagePath);
+
 public Q_SLOTS:
     // markdown-tools editor
     /**
      * @brief Receive the newly available data.
      *
-     * @param md The markdown text to be parsed.
+     * @param snapshot The lines of the markdown text to be parsed.
      * @param noteDir The directory in which the note is located.
      * @param noteName The name of the note.
+     * @param edit The lines touched since the previous data.
      * @param counter The number that will be used as the `parseCount` for the `done` signal.
      */
-    void onData(const QString &md, const QString &noteDir, const QString &noteName, unsigned long long int counter);
+    void onData(const MdEditor::TextSnapshot &snapshot, const QString &noteDir, const QString &noteName, const MdEditor::TextEdit &edit, unsigned long long int counter);
 
 private Q_SLOTS:
     // Note Linking
@@ -142,6 +160,20 @@ private Q_SLOTS:
      */
     void quickEmojiEnabledChanged();
 
+    /**
+     * @brief Connection to KleverNotes config for the default tone of the Quick Emoji Plugin.
+     *
+     * Invokes on the main thread.
+     */
+    void emojiToneChanged();
+
+    /**
+     * @brief Connection to KleverNotes config for the storage path used by the Note Linking Plugin.
+     *
+     * Invokes on the main thread.
+     */
+    void storagePathChanged();
+
     /**
      * @brief Connection to KleverNotes config for the Note Linking Plugin.
      *
@@ -161,6 +193,24 @@ private Q_SLOTS:
      */
     void quickEmojiEnabledChanged(bool on);
 
+    /**
+     * @brief Connection to KleverNotes config for the default tone of the Quick Emoji Plugin.
+     *
+     * Invokes on the parsing thread.
+     *
+     * @param tone The new default tone.
+     */
+    void emojiToneChanged(const QString &tone);
+
+    /**
+     * @brief Connection to KleverNotes config for the storage path used by the Note Linking Plugin.
+     *
+     * Invokes on the parsing thread.
+     *
+     * @param storagePath The new storage path.
+     */
+    void storagePathChanged(const QString &storagePath);
+
     // markdown-tools editor
     /**
      * @brief Receive the request to perform parsing.
@@ -174,12 +224,24 @@ private:
     };
 
     QSet<PluginID> m_plugins;
+    // Read from the config on the main thread, the plugins run on the parsing threads
+    QString m_emojiTone = QStringLiteral("None");
+    QString m_storagePath;
 
     // markdown-tools editor
-    QStringList m_data; // Using a QStringList enable us to make the difference between no data and empty data !!
+    QList<TextSnapshot> m_data; // Using a QList enable us to make the difference between no data and empty data !!
     QString m_noteDir;
     QString m_noteName;
     unsigned long long int m_counter;
     MD::Parser m_md4qtParser;
+
+    // Incremental parsing
+    TextEdit m_pendingEdit = TextEdit::fullEdit();
+    QSharedPointer<MD::Document> m_previousDoc = nullptr;
+    // Set with the KLEVERNOTES_VERIFY_INCREMENTAL_PARSING environment variable
+    const bool m_verifyIncremental;
+
+    // Cancellation
+    QSharedPointer<parseCancellation::Generation> m_generation = nullptr;
 };
 }
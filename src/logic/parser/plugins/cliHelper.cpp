@@ -4,6 +4,8 @@
 #include "cliHelper.h"
 
 #include <KSandbox>
+#include <QDateTime>
+#include <QFileInfo>
 #include <QProcess>
 #include <QStandardPaths>
 
@@ -27,6 +29,32 @@ QString CLIHelper::findExecutable(const QString &command)
     return QStandardPaths::findExecutable(command);
 }
 
+qint64 CLIHelper::lastModified(const QString &path)
+{
+    if (path.isEmpty()) {
+        return 0;
+    }
+
+    if (KSandbox::isInside()) {
+        // The path is on the host
+        QProcess process;
+        process.setProgram(QStringLiteral("stat"));
+        process.setArguments(QStringList() << QStringLiteral("-L") << QStringLiteral("-c") << QStringLiteral("%Y") << path);
+        KSandbox::startHostProcess(process);
+
+        if (!process.waitForStarted()) {
+            return 0;
+        }
+
+        process.waitForFinished(1000);
+
+        return process.exitCode() == 0 ? process.readAllStandardOutput().trimmed().toLongLong() : 0;
+    }
+
+    const QFileInfo info(path);
+    return info.exists() ? info.lastModified().toSecsSinceEpoch() : 0;
+}
+
 QString CLIHelper::execCommand(const QString &input)
 {
     const QString sh = findExecutable(QStringLiteral("sh"));
@@ -49,6 +77,25 @@ QString CLIHelper::execCommand(const QString &input)
     return process.exitCode() == 0 ? QString::fromUtf8(process.readAllStandardOutput()) : QLatin1String();
 }
 
+QString CLIHelper::execProgram(const QString &program, const QStringList &arguments, const QByteArray &standardInput)
+{
+    QProcess process;
+    process.setProgram(program);
+    process.setArguments(arguments);
+    KSandbox::startHostProcess(process);
+
+    if (!process.waitForStarted()) {
+        return {};
+    }
+
+    process.write(standardInput);
+    process.closeWriteChannel();
+
+    process.waitForFinished(5000); // same limit as execCommand
+
+    return process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0 ? QString::fromUtf8(process.readAllStandardOutput()) : QLatin1String();
+}
+
 bool CLIHelper::commandExists(const QString &command)
 {
     return !findExecutable(command).isEmpty();
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <QString>
+#include <QStringList>
 
 /**
  * @class CLIHelper
@@ -20,6 +21,14 @@ public:
      */
     static QString findExecutable(const QString &command);
 
+    /**
+     * @brief Get the last modification time of an executable, changed when it is updated.
+     *
+     * @param path The path of the executable, as given by `findExecutable`.
+     * @return The number of seconds since the epoch, 0 if it can't be found.
+     */
+    static qint64 lastModified(const QString &path);
+
     /**
      * @brief Execute the given input inside a `sh` shell.
      *
@@ -28,6 +37,16 @@ public:
      */
     static QString execCommand(const QString &input);
 
+    /**
+     * @brief Run the given program without a shell, its arguments are not interpreted.
+     *
+     * @param program The name of the program.
+     * @param arguments The arguments given to the program.
+     * @param standardInput The data written to the standard input of the program.
+     * @return The output of the program, empty if it failed.
+     */
+    static QString execProgram(const QString &program, const QStringList &arguments, const QByteArray &standardInput);
+
     /**
      * @brief Check if the given command exists.
      *
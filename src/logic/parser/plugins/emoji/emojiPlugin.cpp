@@ -6,12 +6,15 @@
 #include "emojiPlugin.hpp"
 
 #include "emojiModel.h"
-#include "kleverconfig.h"
+#include "parseCancellation.h"
 
 // md4qt include.
 #include <md4qt/src/inline_context.h>
 #include <md4qt/src/text_stream.h>
 
+// Qt include
+#include <QHash>
+
 namespace EmojiPlugin
 {
 
@@ -28,6 +31,8 @@ void EmojiItem::applyEmojiBase(const EmojiItem &other)
         setEmoji(other.emoji());
         setEmojiNamePos(other.emojiNamePos());
         setOptionsPos(other.optionsPos());
+        setStartDelim(other.startDelim());
+        setEndDelim(other.endDelim());
     }
 }
 
@@ -93,6 +98,124 @@ void EmojiItem::setEndDelim(const MD::WithPosition &pos)
 // !EmojiItem
 
 static const QChar s_colon = QLatin1Char(':');
+// Bound of the resolved emojis cache, the names typed in a note are few
+static constexpr qsizetype MAX_RESOLVED_EMOJIS = 512;
+
+/**
+ * @class ResolvedEmoji
+ * @brief Result of the lookup of an emoji name in the emoji model.
+ */
+struct ResolvedEmoji {
+    QString unicode;
+    bool variantFound = false;
+    bool toneGiven = false;
+    bool defaultToneGiven = false;
+};
+
+/**
+ * @brief Find the emoji matching the given name and options.
+ *
+ * @param face The name of the emoji.
+ * @param options The options following the name (tone, variant), separated by a comma.
+ * @param configTone The tone chosen in the config.
+ * @return The emoji, with an empty unicode if none matches.
+ */
+static ResolvedEmoji resolveEmoji(const QString &face, const QString &options, const QString &configTone)
+{
+    QStringList optionsInfo;
+    if (!options.isEmpty()) {
+        optionsInfo = options.split(QStringLiteral(","));
+    }
+
+    static const auto emojiModel = &EmojiModel::instance();
+    static const QString defaultToneStr = QStringLiteral("default skin tone");
+    static const QSet<QString> tonesOptions = {
+        QStringLiteral("dark skin tone"),
+        QStringLiteral("medium-dark skin tone"),
+        QStringLiteral("medium skin tone"),
+        QStringLiteral("medium-light skin tone"),
+        QStringLiteral("light skin tone"),
+        defaultToneStr, // To possibly overwrite the default in config
+    };
+
+    QString tone = configTone == QStringLiteral("None") ? defaultToneStr : configTone;
+    QString givenVariant;
+    bool toneGiven = false;
+
+    if (!optionsInfo.isEmpty()) {
+        // e.g:
+        // "woman: dark skin tone, blond hair"
+        // "woman: blond hair"
+        const QString possibleTone = optionsInfo[0].trimmed().toLower();
+        if (tonesOptions.contains(possibleTone)) {
+            tone = possibleTone;
+            toneGiven = true;
+        } else {
+            givenVariant = possibleTone;
+        }
+        if (1 < optionsInfo.length()) {
+            givenVariant = optionsInfo[1].trimmed();
+        }
+    }
+
+    const bool defaultToneGiven = tone == defaultToneStr;
+
+    const QString searchTerm = givenVariant.isEmpty() ? face : (face + QStringLiteral(": ") + givenVariant);
+
+    QString uniEmoji;
+    bool variantFound = false;
+
+    if (!defaultToneGiven) { // Check for tones, but will also gives tones + variant
+        const QVariantList tonedEmojis = emojiModel->tones(face);
+        for (auto it = tonedEmojis.begin(); it != tonedEmojis.end(); ++it) {
+            const Emoji currentEmoji = it->value<Emoji>();
+            const QString tonedEmojiName = currentEmoji.shortName;
+            if (tonedEmojiName.contains(QStringLiteral(" ") + tone)) {
+                // The first result are the "closest" to the search term
+                // This ensure a "sain" default if the perfect match is not found
+                if (uniEmoji.isEmpty()) {
+                    uniEmoji = currentEmoji.unicode;
+                }
+
+                // looking for tone + variant
+                if (!givenVariant.isEmpty() && tonedEmojiName.endsWith(givenVariant)) {
+                    uniEmoji = currentEmoji.unicode;
+                    variantFound = true;
+                    break;
+                }
+                // A tone can also come from config
+                if (toneGiven) {
+                    uniEmoji = currentEmoji.unicode;
+                    variantFound = true;
+                    break;
+                }
+            }
+        }
+    } else { // Only check for variant, e.g: "blond hair", "red hair", ...
+        const QVariantList possibleEmojis = emojiModel->filterModelNoCustom(searchTerm);
+        for (auto it = possibleEmojis.begin(); it != possibleEmojis.end(); it++) {
+            const Emoji currentEmoji = it->value<Emoji>();
+            if (currentEmoji.shortName == searchTerm) {
+                uniEmoji = currentEmoji.unicode;
+                variantFound = !givenVariant.isEmpty() || (defaultToneGiven && toneGiven);
+                break;
+            }
+        }
+    }
+
+    if (uniEmoji.isEmpty()) { // Last try to find one
+        const QVariantList possibleEmojis = emojiModel->filterModelNoCustom(face);
+        for (auto it = possibleEmojis.begin(); it != possibleEmojis.end(); it++) {
+            const Emoji currentEmoji = it->value<Emoji>();
+            if (currentEmoji.shortName == face) {
+                uniEmoji = currentEmoji.unicode;
+                break;
+            }
+        }
+    }
+
+    return {uniEmoji, variantFound, toneGiven, defaultToneGiven};
+}
 
 bool EmojiParser::check(MD::Line &line,
                         MD::ParagraphStream &,
@@ -104,6 +227,11 @@ bool EmojiParser::check(MD::Line &line,
                         MD::Parser &,
                         const MD::ReverseSolidusHandler &)
 {
+    // A newer text is waiting, the rest of this parsing will be thrown away
+    if (parseCancellation::isCancelled()) {
+        return false;
+    }
+
     const auto st = line.currentState();
     MD::Line::State toneStartState;
     line.nextChar();
@@ -140,102 +268,28 @@ bool EmojiParser::check(MD::Line &line,
         }
 
         if (faceFound && !face.isEmpty()) {
-            QStringList optionsInfo;
-            if (toneFound && !tone.isEmpty()) {
-                optionsInfo = tone.split(QStringLiteral(","));
-            }
-
             if (!toneFound) {
                 line.restoreState(&toneStartState);
             }
 
-            static const auto emojiModel = &EmojiModel::instance();
-            static const QString defaultToneStr = QStringLiteral("default skin tone");
-            static const QSet<QString> tonesOptions = {
-                QStringLiteral("dark skin tone"),
-                QStringLiteral("medium-dark skin tone"),
-                QStringLiteral("medium skin tone"),
-                QStringLiteral("medium-light skin tone"),
-                QStringLiteral("light skin tone"),
-                defaultToneStr, // To possibly overwrite the default in config
-            };
-
-            const QString configTone = KleverConfig::emojiTone();
-            QString tone = configTone == QStringLiteral("None") ? defaultToneStr : configTone;
-            QString givenVariant;
-            bool toneGiven = false;
-
-            if (!optionsInfo.isEmpty()) {
-                // e.g:
-                // "woman: dark skin tone, blond hair"
-                // "woman: blond hair"
-                const QString possibleTone = optionsInfo[0].trimmed().toLower();
-                if (tonesOptions.contains(possibleTone)) {
-                    tone = possibleTone;
-                    toneGiven = true;
-                } else {
-                    givenVariant = possibleTone;
-                }
-                if (1 < optionsInfo.length()) {
-                    givenVariant = optionsInfo[1].trimmed();
-                }
-            }
+            // Looking a name up goes through the whole emoji model, the same names come back on each parsing
+            thread_local QHash<QString, ResolvedEmoji> resolvedEmojis;
+            const QString &configTone = m_configTone;
+            const QString options = toneFound ? tone : QString();
+            const QString key = configTone + QChar(0) + face + QChar(0) + options;
 
-            const bool defaultToneGiven = tone == defaultToneStr;
-
-            const QString searchTerm = givenVariant.isEmpty() ? face : (face + QStringLiteral(": ") + givenVariant);
-
-            QString uniEmoji;
-            bool variantFound = false;
-
-            if (!defaultToneGiven) { // Check for tones, but will also gives tones + variant
-                const QVariantList tonedEmojis = emojiModel->tones(face);
-                for (auto it = tonedEmojis.begin(); it != tonedEmojis.end(); ++it) {
-                    const Emoji currentEmoji = it->value<Emoji>();
-                    const QString tonedEmojiName = currentEmoji.shortName;
-                    if (tonedEmojiName.contains(QStringLiteral(" ") + tone)) {
-                        // The first result are the "closest" to the search term
-                        // This ensure a "sain" default if the perfect match is not found
-                        if (uniEmoji.isEmpty()) {
-                            uniEmoji = currentEmoji.unicode;
-                        }
-
-                        // looking for tone + variant
-                        if (!givenVariant.isEmpty() && tonedEmojiName.endsWith(givenVariant)) {
-                            uniEmoji = currentEmoji.unicode;
-                            variantFound = true;
-                            break;
-                        }
-                        // A tone can also come from config
-                        if (toneGiven) {
-                            uniEmoji = currentEmoji.unicode;
-                            variantFound = true;
-                            break;
-                        }
-                    }
-                }
-            } else { // Only check for variant, e.g: "blond hair", "red hair", ...
-                const QVariantList possibleEmojis = emojiModel->filterModelNoCustom(searchTerm);
-                for (auto it = possibleEmojis.begin(); it != possibleEmojis.end(); it++) {
-                    const Emoji currentEmoji = it->value<Emoji>();
-                    if (currentEmoji.shortName == searchTerm) {
-                        uniEmoji = currentEmoji.unicode;
-                        variantFound = !givenVariant.isEmpty() || (defaultToneGiven && toneGiven);
-                        break;
-                    }
-                }
-            }
-
-            if (uniEmoji.isEmpty()) { // Last try to find one
-                const QVariantList possibleEmojis = emojiModel->filterModelNoCustom(face);
-                for (auto it = possibleEmojis.begin(); it != possibleEmojis.end(); it++) {
-                    const Emoji currentEmoji = it->value<Emoji>();
-                    if (currentEmoji.shortName == face) {
-                        uniEmoji = currentEmoji.unicode;
-                        break;
-                    }
+            auto resolvedIt = resolvedEmojis.constFind(key);
+            if (resolvedIt == resolvedEmojis.cend()) {
+                if (MAX_RESOLVED_EMOJIS <= resolvedEmojis.size()) {
+                    resolvedEmojis.clear();
                 }
+                resolvedIt = resolvedEmojis.insert(key, resolveEmoji(face, options, configTone));
             }
+            const ResolvedEmoji resolved = resolvedIt.value();
+            const QString &uniEmoji = resolved.unicode;
+            const bool variantFound = resolved.variantFound;
+            const bool toneGiven = resolved.toneGiven;
+            const bool defaultToneGiven = resolved.defaultToneGiven;
 
             if (!uniEmoji.isEmpty()) {
                 if (!variantFound) {
@@ -273,4 +327,9 @@ QString EmojiParser::startDelimiterSymbols() const
 {
     return QStringLiteral(":");
 }
+
+void EmojiParser::setConfigTone(const QString &configTone)
+{
+    m_configTone = configTone;
+}
 }
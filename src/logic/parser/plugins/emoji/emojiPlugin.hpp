@@ -123,5 +123,15 @@ public:
                const MD::ReverseSolidusHandler &rs) override;
 
     QString startDelimiterSymbols() const override;
+
+    /**
+     * @brief Set the tone used when an emoji is written without one.
+     *
+     * @param configTone The tone chosen in the config.
+     */
+    void setConfigTone(const QString &configTone);
+
+private:
+    QString m_configTone = QStringLiteral("None");
 };
 }
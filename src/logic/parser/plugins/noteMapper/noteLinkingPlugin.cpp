@@ -5,8 +5,8 @@
 
 #include "noteLinkingPlugin.hpp"
 
-#include "kleverconfig.h"
 #include "noteMapperParserUtils.h"
+#include "parseCancellation.h"
 
 // md4qt include.
 #include <md4qt/src/inline_context.h>
@@ -58,6 +58,11 @@ bool NoteLinkingParser::check(MD::Line &line,
                               MD::Parser &,
                               const MD::ReverseSolidusHandler &rs)
 {
+    // A newer text is waiting, the rest of this parsing will be thrown away
+    if (parseCancellation::isCancelled()) {
+        return false;
+    }
+
     if (!rs.isPrevReverseSolidus()) {
         const auto st = line.currentState();
 
@@ -108,8 +113,8 @@ bool NoteLinkingParser::check(MD::Line &line,
                         line.nextChar();
 
                         QString relativeNoteDir = QString(path);
-                        if (relativeNoteDir.startsWith(KleverConfig::storagePath())) {
-                            relativeNoteDir.remove(0, KleverConfig::storagePath().length());
+                        if (relativeNoteDir.startsWith(m_storagePath)) {
+                            relativeNoteDir.remove(0, m_storagePath.length());
                         }
                         const QString sanitizedHref = NoteMapperParserUtils::sanitizePath(href, relativeNoteDir);
 
@@ -158,4 +163,9 @@ QString NoteLinkingParser::startDelimiterSymbols() const
 {
     return QStringLiteral("[");
 }
+
+void NoteLinkingParser::setStoragePath(const QString &storagePath)
+{
+    m_storagePath = storagePath;
+}
 }
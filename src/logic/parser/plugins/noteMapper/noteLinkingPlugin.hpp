@@ -28,6 +28,16 @@ public:
                const MD::ReverseSolidusHandler &rs) override;
 
     QString startDelimiterSymbols() const override;
+
+    /**
+     * @brief Set the storage path, removed from the note directory to get the linked note path.
+     *
+     * @param storagePath The storage path chosen in the config.
+     */
+    void setStoragePath(const QString &storagePath);
+
+private:
+    QString m_storagePath;
 };
 
 }
@@ -37,10 +37,10 @@ QString NoteMapperParserUtils::sanitizePath(const QString &_path, const QString
     return valid ? finalPath : QLatin1String();
 }
 
-void NoteMapperParserUtils::setNotePath(const QString &_path)
+void NoteMapperParserUtils::setNotePath(const QString &_path, const QString &storagePath)
 {
     QString path = _path;
-    m_mapperNotePath = path.remove(0, KleverConfig::storagePath().length());
+    m_mapperNotePath = path.remove(0, storagePath.length());
 }
 
 // Not used due to issue: https://invent.kde.org/office/klevernotes/-/issues/17
@@ -92,7 +92,15 @@ void NoteMapperParserUtils::postTok()
 
     // We try to not spam with signals
     if (m_linkedNotesChanged || !m_previousLinkedNotesInfos.isEmpty()) { // The previous is not empty, some links notes are no longer there
-        Q_EMIT m_editorHandler->newLinkedNotesInfos(m_linkedNotesInfos);
+        // The tokenization happens on the rendering thread
+        const auto editorHandler = m_editorHandler;
+        const auto linkedNotesInfos = m_linkedNotesInfos;
+        QMetaObject::invokeMethod(
+            m_editorHandler,
+            [editorHandler, linkedNotesInfos]() {
+                Q_EMIT editorHandler->newLinkedNotesInfos(linkedNotesInfos);
+            },
+            Qt::QueuedConnection);
     }
     m_previousLinkedNotesInfos = m_linkedNotesInfos;
     m_noteHeaders.removeDuplicates();
@@ -31,8 +31,9 @@ public:
      * @brief Set the path to the current note.
      *
      * @param _path The path to the current note.
+     * @param storagePath The storage path, removed from the note path.
      */
-    void setNotePath(const QString &_path);
+    void setNotePath(const QString &_path, const QString &storagePath);
 
     // TODO: Not used => https://invent.kde.org/office/klevernotes/-/issues/17
     void setHeaderInfo(const QStringList &headerInfo);
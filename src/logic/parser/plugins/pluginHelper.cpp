@@ -5,8 +5,6 @@
 
 #include "pluginHelper.h"
 
-#include "kleverconfig.h"
-
 PluginHelper::PluginHelper(MdEditor::EditorHandler *editorHandler)
     : m_highlightParserUtils(new HighlightParserUtils)
     , m_pumlParserUtils(new PUMLParserUtils)
@@ -14,33 +12,58 @@ PluginHelper::PluginHelper(MdEditor::EditorHandler *editorHandler)
     m_mapperParserUtils = new NoteMapperParserUtils(editorHandler);
 }
 
+PluginHelper::~PluginHelper()
+{
+    delete m_highlightParserUtils;
+    delete m_mapperParserUtils;
+    delete m_pumlParserUtils;
+}
+
 void PluginHelper::clearPluginsInfo()
 {
-    if (KleverConfig::codeSynthaxHighlightEnabled()) {
+    if (m_codeHighlightEnabled) {
         m_highlightParserUtils->clearInfo();
     }
-    if (KleverConfig::noteMapEnabled()) {
+    if (m_noteMapEnabled) {
         m_mapperParserUtils->clearInfo();
     }
-    if (KleverConfig::pumlEnabled()) {
+    if (m_pumlEnabled) {
         m_pumlParserUtils->clearInfo();
     }
 }
 
 void PluginHelper::clearPluginsPreviousInfo()
 {
-    if (KleverConfig::noteMapEnabled()) {
+    if (m_noteMapEnabled) {
         m_mapperParserUtils->clearPreviousInfo();
     }
 }
 
 void PluginHelper::postTokChanges()
 {
-    if (KleverConfig::noteMapEnabled()) {
+    if (m_codeHighlightEnabled) {
+        m_highlightParserUtils->postTok();
+    }
+    if (m_noteMapEnabled) {
         m_mapperParserUtils->postTok();
     }
 }
 
+void PluginHelper::setCodeHighlightEnabled(const bool enable)
+{
+    m_codeHighlightEnabled = enable;
+}
+
+void PluginHelper::setNoteMapEnabled(const bool enable)
+{
+    m_noteMapEnabled = enable;
+}
+
+void PluginHelper::setPUMLEnabled(const bool enable)
+{
+    m_pumlEnabled = enable;
+}
+
 // NoteMapper
 NoteMapperParserUtils *PluginHelper::mapperParserUtils() const
 {
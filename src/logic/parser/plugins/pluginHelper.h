@@ -15,11 +15,13 @@
 /**
  * @class PluginHelper
  * @brief Helper class to interact with some plugins.
+ * Used by the rendering thread, the plugins settings are given by the GUI thread.
  */
 class PluginHelper
 {
 public:
     explicit PluginHelper(MdEditor::EditorHandler *editorHandler);
+    ~PluginHelper();
 
     /**
      * @brief Clear all the cached plugin info.
@@ -36,6 +38,27 @@ public:
      */
     void postTokChanges();
 
+    /**
+     * @brief Set whether the code highlighting plugin is enable or not.
+     *
+     * @param enable Whether the plugin is enable.
+     */
+    void setCodeHighlightEnabled(const bool enable);
+
+    /**
+     * @brief Set whether the NoteMapper plugin is enable or not.
+     *
+     * @param enable Whether the plugin is enable.
+     */
+    void setNoteMapEnabled(const bool enable);
+
+    /**
+     * @brief Set whether the PUML plugin is enable or not.
+     *
+     * @param enable Whether the plugin is enable.
+     */
+    void setPUMLEnabled(const bool enable);
+
     // NoteMapper
     /**
      * @brief Get the NoteMapperParserUtils.
@@ -61,6 +84,10 @@ public:
     PUMLParserUtils *pumlParserUtils() const;
 
 private:
+    bool m_codeHighlightEnabled = false;
+    bool m_noteMapEnabled = false;
+    bool m_pumlEnabled = false;
+
     // Synthax highlight
     HighlightParserUtils *m_highlightParserUtils = nullptr;
 
@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+
+#include "highlightCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+
+namespace
+{
+// Bumped when the HTML given by the highlighters changes
+constexpr int CACHE_VERSION = 1;
+constexpr qint64 DEFAULT_MAX_SIZE = 64 * 1024 * 1024;
+
+const QString entrySuffix = QStringLiteral(".html");
+
+void addField(QCryptographicHash &hash, const QString &field)
+{
+    // Length prefixed, the fields can't be mixed up
+    const QByteArray utf8 = field.toUtf8();
+    hash.addData(QByteArray::number(utf8.size()) + ':');
+    hash.addData(utf8);
+}
+}
+
+HighlightCache::HighlightCache(const QString &directory, const qint64 maxSize)
+    : m_directory(directory)
+    , m_maxSize(maxSize)
+{
+}
+
+HighlightCache &HighlightCache::instance()
+{
+    static HighlightCache cache(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/highlight"), DEFAULT_MAX_SIZE);
+    return cache;
+}
+
+QByteArray HighlightCache::key(const QString &code, const QString &lang, const QString &highlighter, const QString &style, const QString &version)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    addField(hash, QString::number(CACHE_VERSION));
+    addField(hash, highlighter);
+    addField(hash, version);
+    addField(hash, style);
+    addField(hash, lang);
+    addField(hash, code);
+    return hash.result().toHex();
+}
+
+QString HighlightCache::find(const QByteArray &key)
+{
+    const QMutexLocker locker(&m_mutex);
+
+    QFile file(entryPath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    const qint64 size = file.size();
+    if (size == 0) {
+        return {};
+    }
+
+    QString html;
+    if (const uchar *data = file.map(0, size)) {
+        html = QString::fromUtf8(reinterpret_cast<const char *>(data), size);
+        file.unmap(const_cast<uchar *>(data));
+    } else {
+        html = QString::fromUtf8(file.readAll());
+    }
+
+    // Its modification time is its last use
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return html;
+}
+
+void HighlightCache::insert(const QByteArray &key, const QString &html)
+{
+    const QMutexLocker locker(&m_mutex);
+
+    const QString path = entryPath(key);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    // Written aside then renamed, a reader never sees a partial entry
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    const QByteArray utf8 = html.toUtf8();
+    file.write(utf8);
+    if (!file.commit()) {
+        return;
+    }
+
+    if (m_size != -1) {
+        m_size += utf8.size();
+    }
+    if (m_size == -1 || m_maxSize < m_size) {
+        evict();
+    }
+}
+
+QString HighlightCache::entryPath(const QByteArray &key) const
+{
+    // Spread over subdirectories, no directory gets huge
+    return m_directory + QLatin1Char('/') + QLatin1String(key.left(2)) + QLatin1Char('/') + QLatin1String(key) + entrySuffix;
+}
+
+void HighlightCache::evict()
+{
+    struct Entry {
+        QDateTime lastUse;
+        qint64 size;
+        QString path;
+    };
+
+    QList<Entry> entries;
+    qint64 size = 0;
+    QDirIterator it(m_directory, {QLatin1Char('*') + entrySuffix}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        entries.append({info.lastModified(), info.size(), info.filePath()});
+        size += info.size();
+    }
+
+    if (m_maxSize < size) {
+        std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+            return a.lastUse < b.lastUse;
+        });
+
+        // Down to 3/4 of the cap, the directory isn't read again at each insertion
+        const qint64 targetSize = m_maxSize / 4 * 3;
+        for (const auto &entry : std::as_const(entries)) {
+            if (size <= targetSize) {
+                break;
+            }
+            if (QFile::remove(entry.path)) {
+                size -= entry.size;
+            }
+        }
+    }
+
+    m_size = size;
+}
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+
+#pragma once
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+
+/**
+ * @class HighlightCache
+ * @brief On-disk cache of the highlighted blocks of code, kept between the sessions.
+ *
+ * Each entry is a file named after the hash of everything the highlighting depends on, holding the UTF-8 HTML.
+ * An entry is read by mapping its file. The least recently used entries are removed once the cache gets too big.
+ */
+class HighlightCache
+{
+public:
+    /**
+     * @param directory The directory of the cache.
+     * @param maxSize The size of the cache, in bytes, above which its least recently used entries are removed.
+     */
+    explicit HighlightCache(const QString &directory, const qint64 maxSize);
+
+    /**
+     * @brief Get the cache of the application, in the XDG cache directory.
+     *
+     * @return The cache.
+     */
+    static HighlightCache &instance();
+
+    /**
+     * @brief Make the key of a highlighted block of code.
+     *
+     * @param code The code.
+     * @param lang The language of the code.
+     * @param highlighter The name of the highlighter.
+     * @param style The style used by the highlighter.
+     * @param version The version of the highlighter, any change makes its entries unreachable.
+     * @return The key.
+     */
+    static QByteArray key(const QString &code, const QString &lang, const QString &highlighter, const QString &style, const QString &version);
+
+    /**
+     * @brief Get the highlighted code of the given key, it becomes the most recently used entry.
+     *
+     * @param key The key made by `key`.
+     * @return The highlighted code, a null string if it's not cached.
+     */
+    QString find(const QByteArray &key);
+
+    /**
+     * @brief Cache the highlighted code of the given key.
+     *
+     * @param key The key made by `key`.
+     * @param html The highlighted code.
+     */
+    void insert(const QByteArray &key, const QString &html);
+
+private:
+    /**
+     * @brief Get the path of the entry of the given key.
+     *
+     * @param key The key.
+     * @return The path of the file of the entry.
+     */
+    QString entryPath(const QByteArray &key) const;
+
+    /**
+     * @brief Remove the least recently used entries until the cache is well under its size cap.
+     */
+    void evict();
+
+    QMutex m_mutex;
+    const QString m_directory;
+    const qint64 m_maxSize;
+    // Size of the entries, -1 until the directory is first read
+    qint64 m_size = -1;
+};
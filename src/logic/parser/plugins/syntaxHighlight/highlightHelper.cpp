@@ -3,38 +3,143 @@
 
 #include "highlightHelper.h"
 #include "../cliHelper.h"
-#include "kleverconfig.h"
+#include "highlightCache.h"
+#include "kSyntaxHtmlHighlighter.h"
+#include "pygmentsCoprocess.h"
+#include "logic/parser/htmlEscape.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QSaveFile>
+#include <QThread>
+
+namespace
+{
+// Bumped when the content of the file changes
+constexpr int DISCOVERY_VERSION = 1;
+
+const QString pathKey = QStringLiteral("path");
+const QString modifiedKey = QStringLiteral("modified");
+const QString stylesKey = QStringLiteral("styles");
+
+QString discoveryPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/highlighters.json");
+}
+}
 
 HighlightHelper::HighlightHelper(QObject *parent)
     : QObject(parent)
 {
-    setAvailableHighlighters();
+    QJsonObject previous;
+    if (!loadDiscovery(previous)) {
+        // First launch, nothing to show until they are found
+        previous = discoverHighlighters({});
+        saveDiscovery(previous);
+        setAvailableHighlighters(previous);
+        return;
+    }
+    setAvailableHighlighters(previous);
+
+    // Listing the styles can take a second, the last ones found are used meanwhile
+    m_discoveryThread = QThread::create([this, previous]() {
+        const QJsonObject highlighters = discoverHighlighters(previous);
+        if (highlighters == previous) {
+            return;
+        }
+        saveDiscovery(highlighters);
+
+        QMetaObject::invokeMethod(
+            this,
+            [this, highlighters]() {
+                setAvailableHighlighters(highlighters);
+                Q_EMIT highlightersChanged();
+            },
+            Qt::QueuedConnection);
+    });
+    m_discoveryThread->setObjectName(QStringLiteral("Highlighters discovery"));
+    m_discoveryThread->start();
 }
 
-QString HighlightHelper::getHighlightedString(const QString &inputStr, const QString &lang)
+HighlightHelper::~HighlightHelper()
 {
-    const QString highlighter = KleverConfig::codeSynthaxHighlighter();
-    const QString style = KleverConfig::codeSynthaxHighlighterStyle();
+    if (m_discoveryThread) {
+        m_discoveryThread->wait();
+        delete m_discoveryThread;
+    }
+}
 
-    if (inputStr.isEmpty() || lang.isEmpty() || !m_availableHighlighters.contains(highlighter)) {
-        return inputStr;
+QString HighlightHelper::getHighlightedString(const QString &inputStr,
+                                              const QString &lang,
+                                              const QString &chosenHighlighter,
+                                              const QString &style,
+                                              PygmentsCoprocess *pygments)
+{
+    const QMap<QString, QStringList> available = availableHighlighters();
+    QString highlighter = chosenHighlighter;
+    if (!available.contains(highlighter)) {
+        highlighter = m_builtinName;
     }
 
-    QString cmd = highlighter + m_highlightersCommands[highlighter].last();
-    static const QRegularExpression nord = QRegularExpression(QStringLiteral("[Nn]ord"));
-    cmd.replace(QStringLiteral("%1"), lang);
-    if (m_availableHighlighters[highlighter].contains(style)) {
-        cmd.replace(nord, style);
+    if (inputStr.isEmpty() || lang.isEmpty()) {
+        return htmlEscape::escape(inputStr);
     }
 
-    const QString echo = QStringLiteral("echo \"") + inputStr + QStringLiteral("\" | ");
+    if (highlighter == m_builtinName) {
+        // Loading the syntax definitions is costly, it is done once per thread: the rendering one and each thread of the
+        // background highlighting pool (at most 4), which never expire
+        thread_local KSyntaxHtmlHighlighter builtinHighlighter;
+        const QString output = builtinHighlighter.highlight(inputStr, lang, style);
+        return output.isEmpty() ? htmlEscape::escape(inputStr) : output;
+    }
 
-    cmd = echo + cmd;
+    // An external highlighter is a process per block, its output is kept between the sessions
+    const QByteArray cacheKey = HighlightCache::key(inputStr, lang, highlighter, style, highlighterVersion(highlighter));
+    QString output = HighlightCache::instance().find(cacheKey);
+    if (!output.isNull()) {
+        return output;
+    }
 
-    QString output = CLIHelper::execCommand(cmd);
+    // The co-process keeps Pygments loaded, the command is only run if it can't start
+    if (pygments && highlighter == m_pygmentizeName) {
+        // Same default style as the command
+        const QString pygmentsStyle = available.value(highlighter).contains(style) ? style : QStringLiteral("nord");
+        output = pygments->highlight(inputStr, lang, pygmentsStyle);
+    }
+    if (output.isNull()) {
+        output = runHighlighter(highlighter, inputStr, lang, style);
+    }
 
     if (output.isEmpty()) {
-        return inputStr;
+        return htmlEscape::escape(inputStr);
+    }
+    HighlightCache::instance().insert(cacheKey, output);
+    return output;
+}
+
+QString HighlightHelper::runHighlighter(const QString &highlighter, const QString &inputStr, const QString &lang, const QString &style)
+{
+    // Run from several threads, the maps are only read
+    QStringList arguments = QProcess::splitCommand(m_highlightersCommands.value(highlighter).last());
+    static const QRegularExpression nord = QRegularExpression(QStringLiteral("[Nn]ord"));
+    const bool knownStyle = availableHighlighters().value(highlighter).contains(style);
+    // Replaced in the split arguments, the lang and the style can't add arguments
+    for (auto &argument : arguments) {
+        if (argument.contains(QStringLiteral("%1"))) {
+            argument.replace(QStringLiteral("%1"), lang);
+        } else if (knownStyle) {
+            argument.replace(nord, style);
+        }
+    }
+
+    // No shell, the code can hold quotes or `$(...)`. Ends with a new line, as given by `echo`
+    const QString output = CLIHelper::execProgram(highlighter, arguments, inputStr.toUtf8() + '\n');
+
+    if (output.isEmpty()) {
+        return {};
     }
 
     const bool isChroma = highlighter == m_chromaName;
@@ -53,26 +158,24 @@ QString HighlightHelper::getHighlightedString(const QString &inputStr, const QSt
 
     const bool correctIndexes = startIndex < endIndex && -1 < startIndex && -1 < endIndex;
 
-    output = correctIndexes ? output.mid(startIndex, endIndex - startIndex) : QString();
-
-    return output.isEmpty() ? inputStr : output;
+    return correctIndexes ? output.mid(startIndex, endIndex - startIndex) : QString();
 }
 
 QStringList HighlightHelper::getHighlighters() const
 {
-    return m_availableHighlighters.keys();
+    return availableHighlighters().keys();
 }
 
 QStringList HighlightHelper::getHighlighterStyle(const QString &highlighter) const
 {
-    return m_availableHighlighters.contains(highlighter) ? m_availableHighlighters[highlighter] : QStringList();
+    return availableHighlighters().value(highlighter);
 }
 
-QStringList HighlightHelper::getHighlighterStyleFromCmd(const QString &highlighter) const
+QStringList HighlightHelper::getHighlighterStyleFromCmd(const QString &highlighter)
 {
     QStringList styles;
 
-    const QString cmd = highlighter + m_highlightersCommands[highlighter].constFirst();
+    const QString cmd = highlighter + m_highlightersCommands.value(highlighter).constFirst();
     const QString output = CLIHelper::execCommand(cmd);
 
     if (output.isEmpty()) {
@@ -101,11 +204,90 @@ QStringList HighlightHelper::getHighlighterStyleFromCmd(const QString &highlight
     return styles;
 }
 
-void HighlightHelper::setAvailableHighlighters()
+QJsonObject HighlightHelper::discoverHighlighters(const QJsonObject &previous)
 {
+    QJsonObject highlighters;
     for (auto it = m_highlightersCommands.cbegin(); it != m_highlightersCommands.cend(); it++) {
-        if (CLIHelper::commandExists(it.key())) {
-            m_availableHighlighters[it.key()] = getHighlighterStyleFromCmd(it.key());
+        const QString path = CLIHelper::findExecutable(it.key());
+        if (path.isEmpty()) {
+            continue;
         }
+        const qint64 modified = CLIHelper::lastModified(path);
+
+        // Same executable, same styles
+        const QJsonObject known = previous.value(it.key()).toObject();
+        if (known.value(pathKey).toString() == path && known.value(modifiedKey).toInteger() == modified) {
+            highlighters.insert(it.key(), known);
+            continue;
+        }
+
+        const QStringList styles = getHighlighterStyleFromCmd(it.key());
+        highlighters.insert(it.key(), QJsonObject{{pathKey, path}, {modifiedKey, modified}, {stylesKey, QJsonArray::fromStringList(styles)}});
+    }
+    return highlighters;
+}
+
+bool HighlightHelper::loadDiscovery(QJsonObject &highlighters)
+{
+    QFile file(discoveryPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(QStringLiteral("version")).toInt() != DISCOVERY_VERSION) {
+        return false;
+    }
+
+    highlighters = root.value(QStringLiteral("highlighters")).toObject();
+    return true;
+}
+
+void HighlightHelper::saveDiscovery(const QJsonObject &highlighters)
+{
+    const QString path = discoveryPath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
     }
+
+    const QJsonObject root{{QStringLiteral("version"), DISCOVERY_VERSION}, {QStringLiteral("highlighters"), highlighters}};
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.commit();
+}
+
+void HighlightHelper::setAvailableHighlighters(const QJsonObject &highlighters)
+{
+    QMap<QString, QStringList> available = {{m_builtinName, KSyntaxHtmlHighlighter::themeNames()}};
+    QHash<QString, QString> versions;
+    for (auto it = highlighters.constBegin(); it != highlighters.constEnd(); it++) {
+        const QJsonObject highlighter = it.value().toObject();
+        QStringList styles;
+        const QJsonArray stylesArray = highlighter.value(stylesKey).toArray();
+        for (const auto &style : stylesArray) {
+            styles.append(style.toString());
+        }
+
+        available.insert(it.key(), styles);
+        // An update replaces the executable
+        versions.insert(it.key(), highlighter.value(pathKey).toString() + QLatin1Char('@') + QString::number(highlighter.value(modifiedKey).toInteger()));
+    }
+
+    const QMutexLocker locker(&m_availableMutex);
+    m_availableHighlighters = available;
+    m_highlighterVersions = versions;
+}
+
+QMap<QString, QStringList> HighlightHelper::availableHighlighters()
+{
+    const QMutexLocker locker(&m_availableMutex);
+    return m_availableHighlighters;
+}
+
+QString HighlightHelper::highlighterVersion(const QString &highlighter)
+{
+    const QMutexLocker locker(&m_availableMutex);
+    return m_highlighterVersions.value(highlighter);
 }
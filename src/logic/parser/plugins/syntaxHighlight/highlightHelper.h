@@ -3,16 +3,23 @@
 
 #pragma once
 
+#include <QHash>
+#include <QJsonObject>
 #include <QMap>
+#include <QMutex>
 #include <QObject>
 #include <QQmlEngine>
 #include <QRegularExpression>
 #include <QStandardPaths>
 
+class PygmentsCoprocess;
+class QThread;
+
 /**
  * @class HighlightHelper
- * @brief Helper class to interact with external code highlighters.
- *
+ * @brief Helper class to interact with the code highlighters.
+ * The built-in highlighter is always available, the external ones are used if they are installed.
+ * The external highlighters found are kept on disk with their styles, they are checked again in the background at each launch.
  */
 class HighlightHelper : public QObject
 {
@@ -20,9 +27,10 @@ class HighlightHelper : public QObject
     QML_ELEMENT
     QML_SINGLETON
 
-    Q_PROPERTY(QStringList highlighters READ getHighlighters CONSTANT)
+    Q_PROPERTY(QStringList highlighters READ getHighlighters NOTIFY highlightersChanged)
 public:
     explicit HighlightHelper(QObject *parent = nullptr);
+    ~HighlightHelper() override;
 
     /**
      * @brief Get the list of the available highlighters.
@@ -40,15 +48,30 @@ public:
     Q_INVOKABLE QStringList getHighlighterStyle(const QString &highlighter) const;
 
     /**
-     * @brief Get an highlighted string based on the given lang and the previously chosen highlighter.
+     * @brief Get an highlighted string based on the given lang and the chosen highlighter.
+     * The built-in highlighter is used if the chosen one is not available.
      *
      * @param inputStr The string to be highlighted.
      * @param lang The language of the code to be highlighted.
+     * @param chosenHighlighter The name of the chosen highlighter, from the settings.
+     * @param style The chosen style, from the settings.
+     * @param pygments The co-process used instead of running `pygmentize` for each string, if any.
      * @return The highlighted input string in form of HTML.
      */
-    static QString getHighlightedString(const QString &inputStr, const QString &lang);
+    static QString getHighlightedString(const QString &inputStr,
+                                        const QString &lang,
+                                        const QString &chosenHighlighter,
+                                        const QString &style,
+                                        PygmentsCoprocess *pygments = nullptr);
+
+Q_SIGNALS:
+    /**
+     * @brief Emitted when the highlighters or their styles changed since the last launch.
+     */
+    void highlightersChanged();
 
 private:
+    inline static const QString m_builtinName = QStringLiteral("KSyntaxHighlighting");
     inline static const QString m_chromaName = QStringLiteral("chroma");
     inline static const QString m_pygmentizeName = QStringLiteral("pygmentize");
     inline static const QString m_kSyntaxName = QStringLiteral("ksyntaxhighlighter6");
@@ -64,27 +87,85 @@ private:
         },
         {
             m_kSyntaxName,
-            {QStringLiteral(" --list-themes"), QStringLiteral(" --stdin -s %1 -f html -t 'Nord' -b")},
+            {QStringLiteral(" --list-themes"), QStringLiteral(" --stdin -s %1 -f html -t Nord -b")},
         },
         {
             m_kateSyntaxName,
-            {QStringLiteral(" --list-themes"), QStringLiteral(" --stdin -s %1 -f html -t 'Nord' -b")},
+            {QStringLiteral(" --list-themes"), QStringLiteral(" --stdin -s %1 -f html -t Nord -b")},
         },
     }; // nord style by default, will be replace by the given style if it exists
 
     inline static const QRegularExpression m_pygmentizeRegex = QRegularExpression(QStringLiteral("(\\* )(.+)(:)"));
 
+    /**
+     * @brief Highlight the given string with an external highlighter.
+     *
+     * @param highlighter The name of the external highlighter.
+     * @param inputStr The string to be highlighted.
+     * @param lang The language of the code to be highlighted.
+     * @param style The style to use if the highlighter has it.
+     * @return The highlighted input string in form of HTML, empty if the highlighter failed.
+     */
+    static QString runHighlighter(const QString &highlighter, const QString &inputStr, const QString &lang, const QString &style);
+
     /**
      * @brief Get the list of all available styles for the given highlighter using the command line.
      *
      * @param highlighter The highlighter for which we want to know the name of the themes.
      * @return A list of all the styles names.
      */
-    QStringList getHighlighterStyleFromCmd(const QString &highlighter) const;
+    static QStringList getHighlighterStyleFromCmd(const QString &highlighter);
+
+    /**
+     * @brief Look for the external highlighters and their styles.
+     * The styles of a highlighter are only listed again if its executable changed.
+     *
+     * @param previous The highlighters found previously.
+     * @return The highlighters found, by name, with their path, modification time and styles.
+     */
+    static QJsonObject discoverHighlighters(const QJsonObject &previous);
 
     /**
-     * @brief Set the list of available highlighters after checking.
+     * @brief Get the highlighters found during the last launch.
+     *
+     * @param highlighters The highlighters found.
+     * @return True if they were looked for, false otherwise.
      */
-    void setAvailableHighlighters();
+    static bool loadDiscovery(QJsonObject &highlighters);
+
+    /**
+     * @brief Keep the highlighters found for the next launch.
+     *
+     * @param highlighters The highlighters found.
+     */
+    static void saveDiscovery(const QJsonObject &highlighters);
+
+    /**
+     * @brief Set the list of available highlighters.
+     *
+     * @param highlighters The external highlighters found, the built-in one is added.
+     */
+    static void setAvailableHighlighters(const QJsonObject &highlighters);
+
+    /**
+     * @brief Get the list of available highlighters, thread-safe.
+     *
+     * @return The styles of the highlighters, by name.
+     */
+    static QMap<QString, QStringList> availableHighlighters();
+
+    /**
+     * @brief Get the version of an external highlighter, thread-safe.
+     *
+     * @param highlighter The name of the highlighter.
+     * @return Its path and modification time.
+     */
+    static QString highlighterVersion(const QString &highlighter);
+
+    // Replaced when the highlighters are checked again, read by the rendering threads
+    inline static QMutex m_availableMutex;
     inline static QMap<QString, QStringList> m_availableHighlighters;
+    inline static QHash<QString, QString> m_highlighterVersions;
+
+    QThread *m_discoveryThread = nullptr;
 };
@@ -5,37 +5,74 @@
 
 #include "highlightParserUtils.h"
 #include "highlightHelper.h"
+#include "logic/parser/htmlEscape.h"
+
+#include <QThread>
+#include <algorithm>
+
+HighlightParserUtils::HighlightParserUtils()
+{
+    // Bounded, the editor and the parsing keep their cores
+    m_pool.setMaxThreadCount(std::clamp(QThread::idealThreadCount() / 2, 1, 4));
+    // The threads keep their highlighter loaded
+    m_pool.setExpiryTimeout(-1);
+}
+
+HighlightParserUtils::~HighlightParserUtils()
+{
+    *m_alive = false;
+    cancelJobs();
+    m_pool.clear();
+    m_pool.waitForDone();
+}
 
 void HighlightParserUtils::clearInfo()
 {
     m_previousHighlightedBlocks = m_currentHighlightedBlocks;
     m_currentHighlightedBlocks.clear();
+
+    // The blocks that the previous render could use but didn't are not in the note anymore
+    ++m_renderNumber;
+    for (auto it = m_finishedBlocks.begin(); it != m_finishedBlocks.end();) {
+        if (it.value().renderNumber + 1 < m_renderNumber) {
+            it = m_finishedBlocks.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
-void HighlightParserUtils::newHighlightStyle()
+void HighlightParserUtils::postTok()
 {
-    m_newHighlightStyle = true;
+    // Typing in a block of code makes a new code at each render, only the latest one is worth highlighting
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        if (m_requestedBlocks.contains(it.key())) {
+            ++it;
+        } else {
+            *it.value() = true;
+            it = m_jobs.erase(it);
+        }
+    }
+    m_requestedBlocks.clear();
 }
 
-QString escape(QString &html, bool encode)
+void HighlightParserUtils::setAsynchronous(QObject *context, const std::function<void()> &highlighted)
 {
-    static const QRegularExpression replace1 = QRegularExpression(QStringLiteral("&(?!#?\\w+;)"));
-    static const QRegularExpression replace2 = QRegularExpression(QStringLiteral("&"));
+    m_context = context;
+    m_highlighted = highlighted;
+}
 
-    const QRegularExpression encodedReplacement = !encode ? replace1 : replace2;
+void HighlightParserUtils::newHighlightStyle(const QString &highlighter, const QString &style)
+{
+    m_highlighter = highlighter;
+    m_style = style;
+    m_newHighlightStyle = true;
 
-    static const QRegularExpression leftBracketReg = QRegularExpression(QStringLiteral("<"));
-    static const QRegularExpression rightBracketReg = QRegularExpression(QStringLiteral(">"));
-    static const QRegularExpression quoteReg = QRegularExpression(QStringLiteral("\""));
-    static const QRegularExpression apostropheReg = QRegularExpression(QStringLiteral("'"));
-    return html.replace(encodedReplacement, QStringLiteral("&amp;"))
-        .replace(leftBracketReg, QStringLiteral("&lt;"))
-        .replace(rightBracketReg, QStringLiteral("&gt;"))
-        .replace(quoteReg, QStringLiteral("&quot;"))
-        .replace(apostropheReg, QStringLiteral("&#39;"));
+    cancelJobs();
+    m_finishedBlocks.clear();
 }
 
-QString HighlightParserUtils::getCode(const bool highlight, const QString &_text, const QString &lang)
+QString HighlightParserUtils::getCode(const bool highlight, const QString &_text, const QString &lang, bool *pending)
 {
     if (m_newHighlightStyle) {
         m_previousHighlightedBlocks.clear();
@@ -43,16 +80,75 @@ QString HighlightParserUtils::getCode(const bool highlight, const QString &_text
     }
     QString code;
     if (!highlight && !lang.isEmpty()) {
-        QString text = _text;
-        code = escape(text, true);
+        code = htmlEscape::escape(_text);
     } else {
         if (m_previousHighlightedBlocks.contains(_text)) {
             code = m_previousHighlightedBlocks.value(_text);
+        } else if (m_finishedBlocks.contains(_text)) {
+            code = m_finishedBlocks.take(_text).html;
+        } else if (m_context) {
+            highlightLater(_text, lang);
+            if (pending) {
+                *pending = true;
+            }
+            return htmlEscape::escape(_text);
         } else {
-            code = HighlightHelper::getHighlightedString(_text, lang);
+            code = HighlightHelper::getHighlightedString(_text, lang, m_highlighter, m_style, &m_pygments);
         }
         m_currentHighlightedBlocks.insert(_text, code);
     }
 
     return code;
 }
+
+void HighlightParserUtils::highlightLater(const QString &text, const QString &lang)
+{
+    m_requestedBlocks.insert(text);
+    if (m_jobs.contains(text)) {
+        return;
+    }
+
+    const auto cancelled = QSharedPointer<std::atomic_bool>::create(false);
+    m_jobs.insert(text, cancelled);
+
+    QObject *context = m_context;
+    m_pool.start([this, context, alive = m_alive, text, lang, highlighter = m_highlighter, style = m_style, cancelled]() {
+        if (*cancelled) {
+            return;
+        }
+
+        // The destructor waits for the jobs, the co-process outlives them
+        const QString html = HighlightHelper::getHighlightedString(text, lang, highlighter, style, &m_pygments);
+        QMetaObject::invokeMethod(
+            context,
+            [this, alive, text, html, cancelled]() {
+                if (*alive) {
+                    onHighlighted(text, html, cancelled);
+                }
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void HighlightParserUtils::onHighlighted(const QString &text, const QString &html, const QSharedPointer<std::atomic_bool> &cancelled)
+{
+    // Cancelled by a newer document or a new style
+    if (*cancelled) {
+        return;
+    }
+    m_jobs.remove(text);
+
+    m_finishedBlocks.insert(text, {html, m_renderNumber});
+    if (m_highlighted) {
+        m_highlighted();
+    }
+}
+
+void HighlightParserUtils::cancelJobs()
+{
+    for (const auto &cancelled : std::as_const(m_jobs)) {
+        *cancelled = true;
+    }
+    m_jobs.clear();
+    m_requestedBlocks.clear();
+}
@@ -5,7 +5,15 @@
 
 #pragma once
 
+#include "pygmentsCoprocess.h"
+
 #include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
 
 /**
  * @class HighlightParserUtils
@@ -14,30 +22,100 @@
 class HighlightParserUtils
 {
 public:
+    HighlightParserUtils();
+    ~HighlightParserUtils();
+
     /**
      * @brief Clear the previously cached highlighted block of code.
      */
     void clearInfo();
 
+    /**
+     * @brief Forget the blocks being highlighted that were not asked for by the last render.
+     */
+    void postTok();
+
+    /**
+     * @brief Highlight the blocks of code in the background from now on.
+     * Until it is highlighted, a block of code is given escaped by `getCode`.
+     *
+     * @param context The object whose thread gets the results, it must outlive this HighlightParserUtils.
+     * @param highlighted Called on the thread of `context` when some blocks of code are highlighted, they are given by the next render.
+     */
+    void setAsynchronous(QObject *context, const std::function<void()> &highlighted);
+
     /**
      * @brief Get a highlighted or escaped code from the input text.
      *
      * @param highlight Whether the code should be highlighted.
      * @param _text The given text to be treated.
      * @param lang The language of the code if it is highlighted.
+     * @param pending Set to true if the code is escaped while it is being highlighted in the background.
      * @return A highlighted or escaped code.
      */
-    QString getCode(const bool highlight, const QString &_text, const QString &lang);
+    QString getCode(const bool highlight, const QString &_text, const QString &lang, bool *pending = nullptr);
 
     /**
-     * @brief Tell the HighlightParserUtils that a new style is being used.
+     * @brief Tell the HighlightParserUtils that a new highlighter or style is being used.
      * Prevents issue with cached info.
+     *
+     * @param highlighter The name of the chosen highlighter.
+     * @param style The chosen style.
      */
-    void newHighlightStyle();
+    void newHighlightStyle(const QString &highlighter, const QString &style);
 
 private:
+    /**
+     * @brief Start highlighting the given code in the background, unless it already is.
+     *
+     * @param text The code.
+     * @param lang The language of the code.
+     */
+    void highlightLater(const QString &text, const QString &lang);
+
+    /**
+     * @brief Receive a code highlighted in the background.
+     *
+     * @param text The code.
+     * @param html The highlighted code.
+     * @param cancelled The cancellation flag of the job.
+     */
+    void onHighlighted(const QString &text, const QString &html, const QSharedPointer<std::atomic_bool> &cancelled);
+
+    /**
+     * @brief Cancel every job, their results are dropped.
+     */
+    void cancelJobs();
+
     bool m_newHighlightStyle = true;
+    // Given by the GUI thread, the highlighting threads get a copy
+    QString m_highlighter;
+    QString m_style;
 
     QHash<QString, QString> m_previousHighlightedBlocks;
     QHash<QString, QString> m_currentHighlightedBlocks;
+
+    // Background highlighting
+    QObject *m_context = nullptr;
+    std::function<void()> m_highlighted;
+    // Cleared by the destructor, the results still queued to `m_context` are then dropped
+    QSharedPointer<bool> m_alive = QSharedPointer<bool>::create(true);
+    // Shared by the jobs, `pygmentize` is not started for each block
+    PygmentsCoprocess m_pygments;
+    QThreadPool m_pool;
+    // Cancellation flag of the jobs, by code
+    QHash<QString, QSharedPointer<std::atomic_bool>> m_jobs;
+    // Code asked for by the current render
+    QSet<QString> m_requestedBlocks;
+    /**
+     * @struct FinishedBlock
+     * @brief A block of code highlighted in the background, waiting for a render to use it.
+     */
+    struct FinishedBlock {
+        QString html;
+        // Number of the render it arrived during, it's dropped if the next one doesn't use it
+        unsigned long long int renderNumber;
+    };
+    QHash<QString, FinishedBlock> m_finishedBlocks;
+    unsigned long long int m_renderNumber = 0;
 };
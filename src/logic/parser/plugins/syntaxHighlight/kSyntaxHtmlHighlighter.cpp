@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+
+#include "kSyntaxHtmlHighlighter.h"
+
+#include "logic/parser/htmlEscape.h"
+#include <KSyntaxHighlighting/Definition>
+#include <KSyntaxHighlighting/Format>
+#include <KSyntaxHighlighting/State>
+#include <KSyntaxHighlighting/Theme>
+#include <QColor>
+#include <utility>
+
+QStringList KSyntaxHtmlHighlighter::themeNames()
+{
+    const KSyntaxHighlighting::Repository repository;
+
+    QStringList names;
+    for (const auto &theme : repository.themes()) {
+        names.append(theme.name());
+    }
+    names.sort();
+    return names;
+}
+
+QString KSyntaxHtmlHighlighter::highlight(const QString &code, const QString &lang, const QString &themeName)
+{
+    auto definition = m_repository.definitionForName(lang);
+    if (!definition.isValid()) {
+        // `cpp`, `py`, `js`, ...
+        definition = m_repository.definitionForFileName(QStringLiteral("code.") + lang);
+    }
+    if (!definition.isValid()) {
+        return {};
+    }
+    setDefinition(definition);
+
+    if (themeName != m_themeName || !theme().isValid()) {
+        const auto namedTheme = m_repository.theme(themeName);
+        setTheme(namedTheme.isValid() ? namedTheme : m_repository.defaultTheme());
+        m_themeName = themeName;
+        m_formatStyles.clear();
+    }
+
+    // Highlighted code is often twice as long as the code
+    m_html.reserve(code.size() * 2);
+
+    // The colors of the theme are made for its own background
+    const QString background = QColor::fromRgba(theme().editorColor(KSyntaxHighlighting::Theme::BackgroundColor)).name();
+    const QString color = QColor::fromRgba(theme().textColor(KSyntaxHighlighting::Theme::Normal)).name();
+    m_html.append(QStringLiteral("<span style=\"display:block;color:"));
+    m_html.append(color);
+    m_html.append(QStringLiteral(";background-color:"));
+    m_html.append(background);
+    m_html.append(QStringLiteral("\">"));
+
+    const QStringView view(code);
+    KSyntaxHighlighting::State state;
+    for (qsizetype start = 0; start <= view.size();) {
+        qsizetype end = view.indexOf(u'\n', start);
+        if (end == -1) {
+            end = view.size();
+        }
+
+        m_line = view.mid(start, end - start);
+        m_lineWritten = 0;
+        state = highlightLine(m_line, state);
+        appendUnformatted(m_line.size());
+
+        if (end < view.size()) {
+            m_html.append(QLatin1Char('\n'));
+        }
+        start = end + 1;
+    }
+    m_html.append(QStringLiteral("</span>"));
+
+    m_line = {};
+    return std::exchange(m_html, QString());
+}
+
+void KSyntaxHtmlHighlighter::applyFormat(int offset, int length, const KSyntaxHighlighting::Format &format)
+{
+    if (length == 0) {
+        return;
+    }
+
+    appendUnformatted(offset);
+
+    const QString &style = formatStyle(format);
+    if (style.isEmpty()) {
+        htmlEscape::appendEscaped(m_html, m_line.mid(offset, length));
+    } else {
+        m_html.append(QStringLiteral("<span style=\""));
+        m_html.append(style);
+        m_html.append(QStringLiteral("\">"));
+        htmlEscape::appendEscaped(m_html, m_line.mid(offset, length));
+        m_html.append(QStringLiteral("</span>"));
+    }
+    m_lineWritten = offset + length;
+}
+
+void KSyntaxHtmlHighlighter::appendUnformatted(const qsizetype offset)
+{
+    if (m_lineWritten < offset) {
+        htmlEscape::appendEscaped(m_html, m_line.mid(m_lineWritten, offset - m_lineWritten));
+        m_lineWritten = offset;
+    }
+}
+
+const QString &KSyntaxHtmlHighlighter::formatStyle(const KSyntaxHighlighting::Format &format)
+{
+    auto it = m_formatStyles.find(format.id());
+    if (it != m_formatStyles.end()) {
+        return it.value();
+    }
+
+    const auto &currentTheme = theme();
+    QString style;
+    if (format.hasTextColor(currentTheme)) {
+        style += QStringLiteral("color:") + format.textColor(currentTheme).name() + QLatin1Char(';');
+    }
+    if (format.hasBackgroundColor(currentTheme)) {
+        style += QStringLiteral("background-color:") + format.backgroundColor(currentTheme).name() + QLatin1Char(';');
+    }
+    if (format.isBold(currentTheme)) {
+        style += QStringLiteral("font-weight:bold;");
+    }
+    if (format.isItalic(currentTheme)) {
+        style += QStringLiteral("font-style:italic;");
+    }
+    if (format.isUnderline(currentTheme)) {
+        style += QStringLiteral("text-decoration:underline;");
+    } else if (format.isStrikeThrough(currentTheme)) {
+        style += QStringLiteral("text-decoration:line-through;");
+    }
+
+    return m_formatStyles.insert(format.id(), style).value();
+}
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+
+#pragma once
+
+#include <KSyntaxHighlighting/AbstractHighlighter>
+#include <KSyntaxHighlighting/Repository>
+#include <QHash>
+#include <QString>
+
+/**
+ * @class KSyntaxHtmlHighlighter
+ * @brief Built-in code highlighter, turning code into HTML spans with KSyntaxHighlighting.
+ *
+ * Unlike the external highlighters, no process is started: the code is highlighted in the calling thread.
+ * The syntax definitions are loaded by the constructor, an instance must stay on the thread that uses it.
+ */
+class KSyntaxHtmlHighlighter : public KSyntaxHighlighting::AbstractHighlighter
+{
+public:
+    KSyntaxHtmlHighlighter() = default;
+
+    /**
+     * @brief Get the names of the themes that can be used.
+     *
+     * @return The sorted names of the themes.
+     */
+    static QStringList themeNames();
+
+    /**
+     * @brief Highlight the given code.
+     *
+     * @param code The code to highlight.
+     * @param lang The language of the code, either the name of a syntax definition or a file extension.
+     * @param themeName The name of the theme, the default theme is used if it's unknown.
+     * @return The highlighted code as HTML with inline styles, empty if the language is unknown.
+     */
+    QString highlight(const QString &code, const QString &lang, const QString &themeName);
+
+protected:
+    void applyFormat(int offset, int length, const KSyntaxHighlighting::Format &format) override;
+
+private:
+    /**
+     * @brief Append the text of the current line that has no format, up to the given offset.
+     *
+     * @param offset The offset in the current line.
+     */
+    void appendUnformatted(const qsizetype offset);
+
+    /**
+     * @brief Get the inline CSS of the given format in the current theme.
+     *
+     * @param format The format.
+     * @return The CSS, empty if the format is the normal text.
+     */
+    const QString &formatStyle(const KSyntaxHighlighting::Format &format);
+
+    KSyntaxHighlighting::Repository m_repository;
+    QString m_themeName;
+    // CSS of each format of the current theme, by format id
+    QHash<quint16, QString> m_formatStyles;
+
+    // Highlighting state
+    QString m_html;
+    QStringView m_line;
+    qsizetype m_lineWritten = 0;
+};
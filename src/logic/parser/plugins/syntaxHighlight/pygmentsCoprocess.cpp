@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+
+#include "pygmentsCoprocess.h"
+#include "../cliHelper.h"
+
+#include <KSandbox>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QThread>
+
+namespace
+{
+// Like the other highlighter commands, if it takes more than that, there's a problem
+constexpr int TIMEOUT_MS = 5000;
+// Consecutive failed requests after which Pygments is considered missing
+constexpr int MAX_FAILURES = 3;
+
+const QString script = QStringLiteral(
+    "import json, sys\n"
+    "from pygments import highlight\n"
+    "from pygments.formatters import HtmlFormatter\n"
+    "from pygments.lexers import get_lexer_by_name\n"
+    "formatters = {}\n"
+    "while True:\n"
+    "    header = sys.stdin.buffer.readline()\n"
+    "    if not header:\n"
+    "        break\n"
+    "    request = json.loads(sys.stdin.buffer.read(int(header)))\n"
+    "    try:\n"
+    "        style = request['style']\n"
+    "        if style not in formatters:\n"
+    "            formatters[style] = HtmlFormatter(style=style, noclasses=True, nowrap=True)\n"
+    "        html = highlight(request['code'], get_lexer_by_name(request['lang']), formatters[style])\n"
+    "        html = html[:-1] if html.endswith('\\n') else html\n"
+    "    except Exception:\n"
+    "        html = ''\n"
+    "    data = html.encode('utf-8')\n"
+    "    sys.stdout.buffer.write(b'%d\\n' % len(data) + data)\n"
+    "    sys.stdout.buffer.flush()\n");
+
+/**
+ * @brief Get the Python interpreter used by `pygmentize`, Pygments is installed for this one.
+ *
+ * @return The program and its arguments.
+ */
+QStringList interpreter()
+{
+    QFile pygmentize(CLIHelper::findExecutable(QStringLiteral("pygmentize")));
+    if (pygmentize.open(QIODevice::ReadOnly)) {
+        const QByteArray shebang = pygmentize.readLine().trimmed();
+        if (shebang.startsWith("#!")) {
+            // `#!/usr/bin/python3` or `#!/usr/bin/env python3`
+            const QStringList command = QString::fromUtf8(shebang.mid(2)).split(QLatin1Char(' '), Qt::SkipEmptyParts);
+            if (!command.isEmpty()) {
+                return command;
+            }
+        }
+    }
+    return {QStringLiteral("python3")};
+}
+
+QByteArray frame(const QByteArray &data)
+{
+    return QByteArray::number(data.size()) + '\n' + data;
+}
+}
+
+PygmentsCoprocess::~PygmentsCoprocess()
+{
+    {
+        const QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_requestAdded.wakeAll();
+    }
+
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+QString PygmentsCoprocess::highlight(const QString &code, const QString &lang, const QString &style)
+{
+    const QJsonObject json{{QStringLiteral("code"), code}, {QStringLiteral("lang"), lang}, {QStringLiteral("style"), style}};
+    Request request{frame(QJsonDocument(json).toJson(QJsonDocument::Compact)), {}};
+    auto result = request.result.get_future();
+
+    {
+        const QMutexLocker locker(&m_mutex);
+        if (m_unavailable || m_stopping) {
+            return {};
+        }
+
+        // The process belongs to this thread, started with the first request
+        if (!m_thread) {
+            m_thread = QThread::create([this]() {
+                run();
+            });
+            m_thread->setObjectName(QStringLiteral("Pygments"));
+            m_thread->start();
+        }
+
+        m_requests.append(&request);
+        m_requestAdded.wakeOne();
+    }
+
+    return result.get();
+}
+
+void PygmentsCoprocess::run()
+{
+    QProcess process;
+    int failures = 0;
+
+    while (true) {
+        QMutexLocker locker(&m_mutex);
+        while (m_requests.isEmpty() && !m_stopping) {
+            m_requestAdded.wait(&m_mutex);
+        }
+        if (m_stopping) {
+            for (auto request : std::as_const(m_requests)) {
+                request->result.set_value({});
+            }
+            m_requests.clear();
+            break;
+        }
+        Request *request = m_requests.takeFirst();
+        const bool unavailable = m_unavailable;
+        locker.unlock();
+
+        QString html;
+        bool answered = false;
+        // Restarted once if it crashed
+        for (int attempt = 0; !unavailable && attempt < 2 && !answered; ++attempt) {
+            answered = ensureStarted(process) && exchange(process, request->frame, html);
+            if (!answered) {
+                process.kill();
+                process.waitForFinished(TIMEOUT_MS);
+            }
+        }
+
+        if (answered) {
+            failures = 0;
+        } else if (++failures == MAX_FAILURES) {
+            locker.relock();
+            m_unavailable = true;
+        }
+        request->result.set_value(answered ? html : QString());
+    }
+
+    // Its standard input is closed, the script ends
+    process.closeWriteChannel();
+    if (!process.waitForFinished(TIMEOUT_MS)) {
+        process.kill();
+        process.waitForFinished(TIMEOUT_MS);
+    }
+}
+
+bool PygmentsCoprocess::ensureStarted(QProcess &process)
+{
+    if (process.state() == QProcess::Running) {
+        return true;
+    }
+
+    const QStringList command = interpreter();
+    process.setProgram(command.constFirst());
+    process.setArguments(command.mid(1) << QStringLiteral("-c") << script);
+    process.setStandardErrorFile(QProcess::nullDevice());
+    KSandbox::startHostProcess(process);
+
+    return process.waitForStarted(TIMEOUT_MS);
+}
+
+bool PygmentsCoprocess::exchange(QProcess &process, const QByteArray &frame, QString &html)
+{
+    process.write(frame);
+    if (!process.waitForBytesWritten(TIMEOUT_MS)) {
+        return false;
+    }
+
+    while (!process.canReadLine()) {
+        if (!process.waitForReadyRead(TIMEOUT_MS)) {
+            return false;
+        }
+    }
+
+    bool ok = false;
+    const qint64 size = process.readLine().trimmed().toLongLong(&ok);
+    if (!ok || size < 0) {
+        return false;
+    }
+
+    QByteArray data;
+    data.reserve(size);
+    while (data.size() < size) {
+        if (process.bytesAvailable() == 0 && !process.waitForReadyRead(TIMEOUT_MS)) {
+            return false;
+        }
+        data += process.read(size - data.size());
+    }
+
+    html = QString::fromUtf8(data);
+    return true;
+}
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+
+#pragma once
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+#include <future>
+
+class QProcess;
+class QThread;
+
+/**
+ * @class PygmentsCoprocess
+ * @brief Long-lived Python process highlighting code with Pygments, started once for the session.
+ *
+ * Running `pygmentize` for each block of code costs a Python interpreter startup per block.
+ * This process imports Pygments once, then answers the requests it reads on its standard input.
+ * Each request and each answer is framed as its size in bytes on its own line, followed by the UTF-8 data.
+ * The process is owned by its own thread, restarted if it crashes, and given up on if it keeps failing.
+ */
+class PygmentsCoprocess
+{
+public:
+    PygmentsCoprocess() = default;
+    ~PygmentsCoprocess();
+
+    Q_DISABLE_COPY(PygmentsCoprocess)
+
+    /**
+     * @brief Highlight the given code, thread-safe. The requests are answered in order.
+     *
+     * @param code The code to highlight.
+     * @param lang The language of the code.
+     * @param style The Pygments style.
+     * @return The highlighted code as HTML, empty if Pygments can't highlight it, null if the process can't run.
+     */
+    QString highlight(const QString &code, const QString &lang, const QString &style);
+
+private:
+    /**
+     * @struct Request
+     * @brief A request waiting for the process.
+     */
+    struct Request {
+        QByteArray frame;
+        std::promise<QString> result;
+    };
+
+    /**
+     * @brief Answer the requests until the destruction, run by the thread owning the process.
+     */
+    void run();
+
+    /**
+     * @brief Start the process if it isn't running.
+     *
+     * @param process The process.
+     * @return True if the process is running, false otherwise.
+     */
+    static bool ensureStarted(QProcess &process);
+
+    /**
+     * @brief Send a request to the process and read its answer.
+     *
+     * @param process The running process.
+     * @param frame The framed request.
+     * @param html The answer.
+     * @return True if the process answered, false otherwise.
+     */
+    static bool exchange(QProcess &process, const QByteArray &frame, QString &html);
+
+    QMutex m_mutex;
+    QWaitCondition m_requestAdded;
+    QList<Request *> m_requests;
+    QThread *m_thread = nullptr;
+    bool m_stopping = false;
+    bool m_unavailable = false;
+};
@@ -0,0 +1,93 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "previewSections.h"
+
+// C++ include
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace
+{
+// Lines added before and after the covered ones while looking for the start and end of their sections
+constexpr qsizetype MAX_SECTION_LINES = 500;
+
+bool isHeading(const QSharedPointer<MD::Item> &item)
+{
+    return item->type() == MD::ItemType::Heading;
+}
+}
+
+namespace previewSections
+{
+Sections around(const QSharedPointer<MD::Document> &doc, const qsizetype firstLine, const qsizetype lastLine)
+{
+    Sections sections;
+    sections.doc = doc;
+    sections.lastLine = std::numeric_limits<qsizetype>::max();
+
+    // The first item is the anchor of the document
+    const auto &items = doc->items();
+    if (items.size() < 2) {
+        return sections;
+    }
+
+    // The top level items are in the order of the text
+    const auto begin = std::next(items.cbegin());
+    qsizetype first = std::partition_point(begin,
+                                           items.cend(),
+                                           [firstLine](const QSharedPointer<MD::Item> &item) {
+                                               return item->endLine() < firstLine;
+                                           })
+        - items.cbegin();
+    qsizetype last = std::partition_point(begin,
+                                          items.cend(),
+                                          [lastLine](const QSharedPointer<MD::Item> &item) {
+                                              return item->startLine() <= lastLine;
+                                          })
+        - items.cbegin() - 1;
+    first = std::min<qsizetype>(first, items.size() - 1);
+    last = std::max(last, first);
+
+    // Up to the heading opening the first section
+    while (1 < first && !isHeading(items.at(first)) && firstLine - MAX_SECTION_LINES <= items.at(first - 1)->startLine()) {
+        --first;
+    }
+    // Up to the heading opening the next section
+    while (last + 1 < items.size() && !isHeading(items.at(last + 1)) && items.at(last + 1)->endLine() <= lastLine + MAX_SECTION_LINES) {
+        ++last;
+    }
+
+    if (first == 1 && last == items.size() - 1) {
+        return sections;
+    }
+
+    sections.firstLine = first == 1 ? 0 : items.at(first - 1)->endLine() + 1;
+    sections.lastLine = last == items.size() - 1 ? std::numeric_limits<qsizetype>::max() : items.at(last + 1)->startLine() - 1;
+
+    sections.doc = QSharedPointer<MD::Document>::create();
+    sections.doc->appendItem(items.at(0));
+    for (qsizetype i = first; i <= last; ++i) {
+        sections.doc->appendItem(items.at(i));
+    }
+
+    const auto &footnotes = doc->footnotesMap();
+    for (auto it = footnotes.cbegin(); it != footnotes.cend(); ++it) {
+        sections.doc->insertFootnote(it.key(), it.value());
+    }
+    const auto &labeledLinks = doc->labeledLinks();
+    for (auto it = labeledLinks.cbegin(); it != labeledLinks.cend(); ++it) {
+        sections.doc->insertLabeledLink(it.key(), it.value());
+    }
+    const auto &labeledHeadings = doc->labeledHeadings();
+    for (auto it = labeledHeadings.cbegin(); it != labeledHeadings.cend(); ++it) {
+        sections.doc->insertLabeledHeading(it.key(), it.value());
+    }
+    sections.doc->auxLabelsMap() = doc->auxLabelsMap();
+
+    return sections;
+}
+}
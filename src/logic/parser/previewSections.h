@@ -0,0 +1,52 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#pragma once
+
+// md4qt include
+#include <md4qt/src/doc.h>
+
+// Qt include
+#include <QSharedPointer>
+
+namespace previewSections
+{
+/**
+ * @struct Sections
+ * @brief Part of a document holding the sections around some lines.
+ */
+struct Sections {
+    // The document made of the sections, sharing its items with the full document
+    QSharedPointer<MD::Document> doc;
+    // Lines covered by the sections, including the blank lines around them
+    qsizetype firstLine = 0;
+    qsizetype lastLine = -1;
+
+    /**
+     * @brief Check if the given lines are covered by the sections.
+     *
+     * @param first The first line.
+     * @param last The last line.
+     * @return True if the lines are covered, false otherwise.
+     */
+    bool covers(const qsizetype first, const qsizetype last) const
+    {
+        return firstLine <= first && last <= lastLine;
+    }
+};
+
+/**
+ * @brief Get the sections of the document around the given lines.
+ *
+ * A section goes from a top level heading to the next one, it is cut if longer than a few hundred lines.
+ * The footnotes, labeled links and headings of the whole document are kept, the links to other sections still work.
+ *
+ * @param doc The full document.
+ * @param firstLine The first line to cover.
+ * @param lastLine The last line to cover.
+ * @return The sections around the lines.
+ */
+Sections around(const QSharedPointer<MD::Document> &doc, const qsizetype firstLine, const qsizetype lastLine);
+}
@@ -0,0 +1,156 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "renderWorker.h"
+
+// KleverNotes include
+#include "logic/editor/editorTrace.hpp"
+
+// Qt include
+#include <QHash>
+
+// C++ include
+#include <utility>
+
+namespace
+{
+/**
+ * @brief Give each block an id that stays the same as long as its HTML does.
+ *
+ * @param blocks The HTML of the blocks.
+ * @return The ids of the blocks.
+ */
+QStringList blockIds(const QStringList &blocks)
+{
+    QStringList ids;
+    ids.reserve(blocks.size());
+
+    // Identical blocks, like empty anchors or thematic breaks, are told apart by their ordinal
+    QHash<size_t, int> occurrences;
+    for (const auto &block : blocks) {
+        const size_t hash = qHash(block);
+        ids.append(QString::number(qulonglong(hash), 36) + QLatin1Char('-') + QString::number(occurrences[hash]++));
+    }
+    return ids;
+}
+}
+
+namespace MdEditor
+{
+RenderWorker::RenderWorker(EditorHandler *editorHandler)
+    : m_renderer(new Renderer())
+    , m_pluginHelper(new PluginHelper(editorHandler))
+{
+    m_renderer->addPluginHelper(m_pluginHelper);
+    m_pluginHelper->highlightParserUtils()->setAsynchronous(this, [this]() {
+        onHighlighted();
+    });
+
+    connect(this, &RenderWorker::newData, this, &RenderWorker::onRender, Qt::QueuedConnection);
+}
+
+RenderWorker::~RenderWorker()
+{
+    delete m_renderer;
+    delete m_pluginHelper;
+}
+
+// Rendering slots
+// ===============
+void RenderWorker::onData(QSharedPointer<MD::Document> mdDoc, const MdEditor::TextSnapshot &source, unsigned long long int parseCount)
+{
+    const bool alreadyQueued = !m_mdDoc.isNull();
+
+    m_mdDoc = mdDoc;
+    m_source = source;
+    m_counter = parseCount;
+
+    if (!alreadyQueued) {
+        Q_EMIT newData();
+    }
+}
+
+void RenderWorker::onRender()
+{
+    if (m_mdDoc) {
+        const editorTrace::Span span("render", m_counter);
+
+        // Per render info, the previous render info is kept as a cache
+        m_pluginHelper->clearPluginsInfo();
+
+        const auto blocks = m_renderer->toHtmlBlocks(m_mdDoc, m_source, QStringLiteral("&nbsp;&hookleftarrow;&nbsp;"));
+        m_pluginHelper->postTokChanges();
+        editorTrace::counter("renderAllocatedBytes", m_renderer->allocatedBytes());
+
+        // Rendered again when its blocks of code are highlighted
+        m_renderedDoc = std::exchange(m_mdDoc, nullptr);
+        m_renderedSource = std::exchange(m_source, TextSnapshot());
+        m_renderedCounter = m_counter;
+
+        Q_EMIT done(blockIds(blocks), blocks, m_counter);
+    }
+}
+
+void RenderWorker::onHighlighted()
+{
+    // Already queued otherwise
+    if (m_renderedDoc && !m_mdDoc) {
+        onData(m_renderedDoc, m_renderedSource, m_renderedCounter);
+    }
+}
+// !Rendering slots
+
+// Renderer and plugins state
+// ==========================
+void RenderWorker::setNoteDir(const QString &noteDir, const QString &storagePath)
+{
+    m_renderer->setNoteDir(noteDir);
+    m_renderedDoc.reset();
+    m_renderedSource = TextSnapshot();
+
+    // We do this here because we're sure to be in another note
+    m_pluginHelper->clearPluginsPreviousInfo();
+    m_pluginHelper->mapperParserUtils()->setNotePath(noteDir, storagePath);
+}
+
+void RenderWorker::addExtendedSyntax(const long long int opts, const QString &openingHTML, const QString &closingHTML)
+{
+    m_renderer->addExtendedSyntax(opts, openingHTML, closingHTML);
+}
+
+void RenderWorker::setCodeHighlightEnable(const bool enable)
+{
+    m_renderer->setCodeHighlightEnable(enable);
+    m_pluginHelper->setCodeHighlightEnabled(enable);
+}
+
+void RenderWorker::setParserSettings(const bool quickEmoji, const QString &emojiTone, const bool noteMap)
+{
+    m_renderer->setParserSettings(quickEmoji, emojiTone, noteMap);
+}
+
+void RenderWorker::setNoteMapEnable(const bool enable)
+{
+    m_pluginHelper->setNoteMapEnabled(enable);
+}
+
+void RenderWorker::newHighlightStyle(const QString &highlighter, const QString &style)
+{
+    m_pluginHelper->highlightParserUtils()->newHighlightStyle(highlighter, style);
+    m_renderer->clearBlockCache();
+}
+
+void RenderWorker::setPUMLenable(const bool enable)
+{
+    m_renderer->setPUMLenable(enable);
+    m_pluginHelper->setPUMLEnabled(enable);
+}
+
+void RenderWorker::setPUMLdark(const bool dark)
+{
+    m_renderer->setPUMLdark(dark);
+}
+// !Renderer and plugins state
+}
@@ -0,0 +1,151 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#pragma once
+
+// Qt include
+#include <QObject>
+#include <QSharedPointer>
+
+// KleverNotes include
+#include "plugins/pluginHelper.h"
+#include "renderer.h"
+#include "textSnapshot.h"
+
+// md4qt include
+#include <md4qt/src/doc.h>
+
+namespace MdEditor
+{
+class EditorHandler;
+
+/**
+ * @class RenderWorker
+ * @brief Class owning the Renderer and the plugins state, living on its own thread.
+ *
+ * Every access to the Renderer and to the PluginHelper must go through the slots of this class,
+ * using queued connections, so that the plugins state is only touched by the rendering thread.
+ */
+class RenderWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RenderWorker(EditorHandler *editorHandler);
+    ~RenderWorker() override;
+
+Q_SIGNALS:
+    /**
+     * @brief Tells the worker that a new document is available.
+     */
+    void newData();
+
+    /**
+     * @brief The rendering is finished.
+     *
+     * @param blockIds The id of each block, made of the hash of its HTML and its ordinal among the blocks sharing this hash.
+     * @param blocks The HTML of each block.
+     * @param parseCount The parsing number of the rendered MD::Document.
+     */
+    void done(const QStringList &blockIds, const QStringList &blocks, unsigned long long int parseCount);
+
+public Q_SLOTS:
+    /**
+     * @brief Receive the newly available document.
+     * Only the latest document is rendered, the previous ones are dropped.
+     *
+     * @param mdDoc The MD::Document to render.
+     * @param source The text the MD::Document was parsed from, the unchanged blocks are reused from the previous renders.
+     * @param parseCount The parsing number of the MD::Document, sent back with the `done` signal.
+     */
+    void onData(QSharedPointer<MD::Document> mdDoc, const MdEditor::TextSnapshot &source, unsigned long long int parseCount);
+
+    /**
+     * @brief Set the current note directory.
+     *
+     * @param noteDir The current note directory.
+     * @param storagePath The storage path, read from the config on the main thread.
+     */
+    void setNoteDir(const QString &noteDir, const QString &storagePath);
+
+    /**
+     * @brief Add an extended syntax in the renderer.
+     *
+     * @param opts The unique opts value of the extended syntax.
+     * @param openingHTML The opening HTML tag(s) for the extended syntax.
+     * @param closingHTML The closing HTML tag(s) for the extended syntax.
+     */
+    void addExtendedSyntax(const long long int opts, const QString &openingHTML, const QString &closingHTML);
+
+    /**
+     * @brief Set whether the code highlighting plugin is enable or not.
+     *
+     * @param enable Whether the plugin is enable.
+     */
+    void setCodeHighlightEnable(const bool enable);
+
+    /**
+     * @brief Set the parser settings, the rendered blocks depend on them.
+     *
+     * @param quickEmoji Whether the quick emoji are enabled.
+     * @param emojiTone The default tone of the emoji.
+     * @param noteMap Whether the note map is enabled.
+     */
+    void setParserSettings(const bool quickEmoji, const QString &emojiTone, const bool noteMap);
+
+    /**
+     * @brief Set whether the NoteMapper plugin is enable or not.
+     *
+     * @param enable Whether the plugin is enable.
+     */
+    void setNoteMapEnable(const bool enable);
+
+    /**
+     * @brief Tell the code highlighting plugin that a new highlighter or style is being used.
+     *
+     * @param highlighter The name of the chosen highlighter.
+     * @param style The chosen style.
+     */
+    void newHighlightStyle(const QString &highlighter, const QString &style);
+
+    /**
+     * @brief Set whether the PUML plugin is enable or not.
+     *
+     * @param enable Whether the plugin is enable.
+     */
+    void setPUMLenable(const bool enable);
+
+    /**
+     * @brief Set whether the PUML plugin should use dark background.
+     *
+     * @param dark Whether the plugin uses dark background.
+     */
+    void setPUMLdark(const bool dark);
+
+private Q_SLOTS:
+    /**
+     * @brief Receive the request to perform the rendering.
+     */
+    void onRender();
+
+private:
+    /**
+     * @brief Render the last document again, some of its blocks of code were highlighted in the background.
+     */
+    void onHighlighted();
+
+    Renderer *m_renderer = nullptr;
+    PluginHelper *m_pluginHelper = nullptr;
+
+    QSharedPointer<MD::Document> m_mdDoc = nullptr;
+    TextSnapshot m_source;
+    unsigned long long int m_counter = 0;
+
+    // Last rendered document
+    QSharedPointer<MD::Document> m_renderedDoc = nullptr;
+    TextSnapshot m_renderedSource;
+    unsigned long long int m_renderedCounter = 0;
+};
+}
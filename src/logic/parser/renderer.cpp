@@ -5,11 +5,78 @@
 
 #include "renderer.h"
 
+#include "htmlEscape.h"
+#include "logic/editor/editorTrace.hpp"
+
 #include <QDir>
-#include <QRegularExpression>
+#include <QSet>
 #include <QUrl>
 #include <qstringliteral.h>
 
+namespace
+{
+/**
+ * @brief Count the elements left open after the given HTML.
+ * Void and self-closing elements are skipped, a closing tag closes the last open element.
+ *
+ * @param html The HTML of a block.
+ * @param openElements The elements left open before this block.
+ * @return The elements left open after this block.
+ */
+qsizetype openElementsAfter(QStringView html, qsizetype openElements)
+{
+    static const QSet<QString> voidElements = {QStringLiteral("area"),
+                                               QStringLiteral("base"),
+                                               QStringLiteral("br"),
+                                               QStringLiteral("col"),
+                                               QStringLiteral("embed"),
+                                               QStringLiteral("hr"),
+                                               QStringLiteral("img"),
+                                               QStringLiteral("input"),
+                                               QStringLiteral("link"),
+                                               QStringLiteral("meta"),
+                                               QStringLiteral("param"),
+                                               QStringLiteral("source"),
+                                               QStringLiteral("track"),
+                                               QStringLiteral("wbr")};
+
+    for (qsizetype pos = html.indexOf(u'<'); pos != -1; pos = html.indexOf(u'<', pos + 1)) {
+        if (html.sliced(pos).startsWith(u"<!--")) {
+            pos = html.indexOf(u"-->", pos);
+            if (pos == -1) {
+                break;
+            }
+            continue;
+        }
+
+        const bool closing = pos + 1 < html.size() && html.at(pos + 1) == u'/';
+        const qsizetype nameStart = pos + (closing ? 2 : 1);
+        qsizetype nameEnd = nameStart;
+        while (nameEnd < html.size() && (html.at(nameEnd).isLetterOrNumber() || html.at(nameEnd) == u'-')) {
+            ++nameEnd;
+        }
+        // Not a tag, like `<!DOCTYPE` or a lone `<`
+        if (nameEnd == nameStart || !html.at(nameStart).isLetter()) {
+            continue;
+        }
+
+        const qsizetype tagEnd = html.indexOf(u'>', nameEnd);
+        if (tagEnd == -1) {
+            break;
+        }
+
+        if (closing) {
+            openElements = qMax<qsizetype>(0, openElements - 1);
+        } else if (html.at(tagEnd - 1) != u'/' && !voidElements.contains(html.sliced(nameStart, nameEnd - nameStart).toString().toLower())) {
+            ++openElements;
+        }
+        pos = tagEnd;
+    }
+
+    return openElements;
+}
+}
+
 Renderer::Renderer()
     : MD::details::HtmlVisitor() { };
 
@@ -79,6 +146,11 @@ void Renderer::onHeading(
     //! Heading tag.
     const QString &ht)
 {
+    // The labels of the nested headings depend on the rest of the document
+    if (h != m_currentBlock) {
+        m_currentBlockCacheable = false;
+    }
+
     if (!m_justCollectFootnoteRefs) {
         m_html.push_back(QStringLiteral("<"));
         m_html.push_back(ht);
@@ -104,12 +176,23 @@ void Renderer::onLink(MD::Link *l)
             auto linkedNoteInfo = l->url().split(wikilinkDelim);
             linkedNoteInfo.append(l->text());
             m_pluginHelper->mapperParserUtils()->addToLinkedNoteInfos(linkedNoteInfo);
+            if (m_currentBlock) {
+                m_currentBlockLinkedNoteInfos.append(linkedNoteInfo);
+            }
         }
     }
 
     MD::details::HtmlVisitor::onLink(l);
 }
 
+void Renderer::onFootnoteRef(MD::FootnoteRef *ref)
+{
+    // The number of the reference depends on the previous blocks
+    m_currentBlockCacheable = false;
+
+    MD::details::HtmlVisitor::onFootnoteRef(ref);
+}
+
 void Renderer::onImage(MD::Image *i)
 {
     if (!m_justCollectFootnoteRefs) {
@@ -126,7 +209,7 @@ void Renderer::onImage(MD::Image *i)
 
         openStyle(i->openStyles());
 
-        m_html.push_back(image(url, i->text()));
+        image(m_html, url, i->text());
 
         closeStyle(i->closeStyles());
     }
@@ -139,7 +222,7 @@ void Renderer::onListItem(MD::ListItem *i, bool first, bool skipOpeningWrap)
     const int startNum = i->listType() == MD::ListItem::Ordered && first ? i->startNumber() : -1;
 
     if (!m_justCollectFootnoteRefs) {
-        m_html.push_back(openListItem(hasTask, isChecked, startNum));
+        openListItem(m_html, hasTask, isChecked, startNum);
     }
 
     // Add the text
@@ -159,20 +242,22 @@ void Renderer::onCode(MD::Code *c)
         const QString lang = c->syntax();
         const QString text = c->text();
 
-        QString returnValue;
         if (m_pluginHelper && m_pumlEnable && (lang.toLower() == pumlStr || lang.toLower() == plantUMLStr)) {
+            const editorTrace::Span span("puml");
             QPair<QString, QString> imageInfo = m_pluginHelper->pumlParserUtils()->renderCode(text, m_pumlDark);
 
-            returnValue = image(imageInfo.first, imageInfo.second);
-        } else {
-            QString code = prepareTextForHtml(text);
-            if (m_pluginHelper && !lang.isEmpty()) {
-                code = m_pluginHelper->highlightParserUtils()->getCode(m_codeHighlight, text, lang);
+            image(m_html, imageInfo.first, imageInfo.second);
+        } else if (m_pluginHelper && !lang.isEmpty()) {
+            const editorTrace::Span span("codeHighlight");
+            bool pending = false;
+            code(m_html, m_pluginHelper->highlightParserUtils()->getCode(m_codeHighlight, text, lang, &pending));
+            // Rendered again once highlighted
+            if (pending) {
+                m_currentBlockCacheable = false;
             }
-            returnValue = Renderer::code(code);
+        } else {
+            code(m_html, prepareTextForHtml(text));
         }
-
-        m_html.push_back(returnValue);
     }
 }
 
@@ -199,7 +284,8 @@ void Renderer::onEmoji(EmojiPlugin::EmojiItem *e)
     if (!m_justCollectFootnoteRefs) {
         openStyle(e->openStyles());
         const QString emoji = e->emoji();
-        m_html.push_back(QStringLiteral("<a href=\"copy:") + emoji);
+        m_html.push_back(QStringLiteral("<a href=\"copy:"));
+        m_html.push_back(emoji);
         m_html.push_back(QStringLiteral("\" style=\"text-decoration:none\">"));
         m_html.push_back(emoji);
         m_html.push_back(QStringLiteral("</a>"));
@@ -218,6 +304,10 @@ QString Renderer::getNoteDir() const
 void Renderer::setNoteDir(const QString &noteDir)
 {
     m_noteDir = noteDir;
+    clearBlockCache();
+
+    // Sized for the previous note
+    m_html = QString();
 }
 
 void Renderer::addPluginHelper(PluginHelper *pluginHelper)
@@ -228,30 +318,266 @@ void Renderer::addPluginHelper(PluginHelper *pluginHelper)
 void Renderer::addExtendedSyntax(const long long int opts, const QString &openingHTML, const QString &closingHTML)
 {
     m_extendedSyntaxMap[opts] = {openingHTML, closingHTML};
+    clearBlockCache();
 }
 
 // Plugins
 void Renderer::setPUMLenable(const bool enable)
 {
     m_pumlEnable = enable;
+    clearBlockCache();
 }
 
 void Renderer::setPUMLdark(const bool dark)
 {
     m_pumlDark = dark;
     m_pluginHelper->pumlParserUtils()->pumlDarkChanged();
+    clearBlockCache();
 }
 
 void Renderer::setCodeHighlightEnable(const bool enable)
 {
     m_codeHighlight = enable;
+    clearBlockCache();
+}
+
+void Renderer::setParserSettings(const bool quickEmoji, const QString &emojiTone, const bool noteMap)
+{
+    m_parserSettingsKey = qHashMulti(0, quickEmoji, emojiTone, noteMap);
+}
+
+void Renderer::clearBlockCache()
+{
+    m_blockCache.clear();
 }
 // !Plugins
 // !Internal info
 
 // Rendering
 // =========
-QString Renderer::code(QString &code)
+QStringList Renderer::toHtmlBlocks(QSharedPointer<MD::Document> doc, const QString &footnoteBackLinkContent)
+{
+    return renderBlocks(doc, nullptr, footnoteBackLinkContent);
+}
+
+QStringList Renderer::toHtmlBlocks(QSharedPointer<MD::Document> doc, const MdEditor::TextSnapshot &source, const QString &footnoteBackLinkContent)
+{
+    return renderBlocks(doc, &source, footnoteBackLinkContent);
+}
+
+QStringList Renderer::renderBlocks(QSharedPointer<MD::Document> doc, const MdEditor::TextSnapshot *source, const QString &footnoteBackLinkContent)
+{
+    // Same state as `toHtml`
+    m_isWrappedInArticle = true;
+    m_idsMap = nullptr;
+    m_fns.clear();
+
+    // Kept from the previous render of the note, its capacity already fits its blocks
+    m_html.resize(0);
+    m_htmlCapacity = m_html.capacity();
+    m_allocatedBytes = 0;
+
+    m_doc = doc;
+    m_anchors.clear();
+    for (const auto &item : doc->items()) {
+        if (item->type() == MD::ItemType::Anchor) {
+            m_anchors.push_back(static_cast<MD::Anchor *>(item.get())->label());
+        }
+    }
+
+    const size_t context = source ? contextKey(doc) : 0;
+    QHash<size_t, CachedBlock> usedBlocks;
+
+    QStringList blocks;
+    blocks.reserve(doc->items().size() + 1);
+
+    // The page parses each block on its own, raw HTML left open, like `<details>`, keeps the next blocks until it is closed
+    qsizetype openElements = 0;
+    const auto appendBlock = [&blocks, &openElements](const QString &html, const bool rawHtml) {
+        const bool merged = 0 < openElements;
+        if (merged) {
+            blocks.last().append(html);
+        } else {
+            blocks.append(html);
+        }
+
+        if (merged || rawHtml) {
+            openElements = openElementsAfter(html, openElements);
+        }
+    };
+
+    for (const auto &item : doc->items()) {
+        const bool rawHtml = item->type() == MD::ItemType::RawHtml;
+        const size_t key = source ? blockKey(item.get(), *source, context) : 0;
+        if (key != 0) {
+            const auto it = m_blockCache.constFind(key);
+            if (it != m_blockCache.cend() && it->isFrom(item.get(), *source)) {
+                // Same side effects as rendering it
+                if (m_pluginHelper) {
+                    for (const auto &linkedNoteInfo : it->linkedNoteInfos) {
+                        m_pluginHelper->mapperParserUtils()->addToLinkedNoteInfos(linkedNoteInfo);
+                    }
+                }
+                appendBlock(it->html, rawHtml);
+                usedBlocks.insert(key, it.value());
+                continue;
+            }
+        }
+
+        m_currentBlock = item.get();
+        m_currentBlockCacheable = key != 0;
+        m_currentBlockLinkedNoteInfos.clear();
+
+        onBlock(item.get());
+        const QString html = takeBlock();
+        appendBlock(html, rawHtml);
+
+        if (m_currentBlockCacheable) {
+            const QString label = item->type() == MD::ItemType::Heading ? static_cast<MD::Heading *>(item.get())->label() : QString();
+            usedBlocks.insert(key, {html, m_currentBlockLinkedNoteInfos, item->type(), blockSource(item.get(), *source), label});
+        }
+    }
+    m_currentBlock = nullptr;
+
+    if (source) {
+        m_blockCache = std::move(usedBlocks);
+    }
+
+    // Their numbers depend on the order of the references, the footnotes come last
+    onFootnotes(footnoteBackLinkContent);
+    if (!m_html.isEmpty()) {
+        appendBlock(takeBlock(), false);
+    }
+
+    return blocks;
+}
+
+QString Renderer::takeBlock()
+{
+    // Each growth of the buffer is a new allocation
+    if (m_htmlCapacity < m_html.capacity()) {
+        m_htmlCapacity = m_html.capacity();
+        m_allocatedBytes += m_htmlCapacity * sizeof(QChar);
+    }
+
+    // Copied at its exact size, the buffer keeps its capacity for the next block
+    QString block(m_html.constData(), m_html.size());
+    m_allocatedBytes += block.size() * sizeof(QChar);
+    m_html.resize(0);
+
+    return block;
+}
+
+qsizetype Renderer::allocatedBytes() const
+{
+    return m_allocatedBytes;
+}
+
+size_t Renderer::contextKey(QSharedPointer<MD::Document> doc) const
+{
+    // The plugins settings change the parsed items, not their source
+    size_t key = m_parserSettingsKey;
+
+    // The links to a label or to a heading of the note are resolved with the whole document
+    for (auto it = doc->labeledLinks().cbegin(); it != doc->labeledLinks().cend(); ++it) {
+        key = qHashMulti(key, it.key(), it.value()->url());
+    }
+    for (auto it = doc->labeledHeadings().cbegin(); it != doc->labeledHeadings().cend(); ++it) {
+        key = qHash(it.key(), key);
+    }
+    return key;
+}
+
+size_t Renderer::blockKey(MD::Item *item, const MdEditor::TextSnapshot &source, const size_t context)
+{
+    const qsizetype startLine = item->startLine();
+    const qsizetype endLine = item->endLine();
+    if (item->type() == MD::ItemType::Anchor || startLine < 0 || endLine < startLine || source.lineCount() <= endLine) {
+        return 0;
+    }
+
+    size_t key = qHash(static_cast<int>(item->type()), context);
+    for (qsizetype line = startLine; line <= endLine; ++line) {
+        key = qHash(QStringView(source.line(line)), key);
+    }
+    // Its label depends on the headings before it
+    if (item->type() == MD::ItemType::Heading) {
+        key = qHash(static_cast<MD::Heading *>(item)->label(), key);
+    }
+
+    // 0 is kept for the blocks that can't be cached
+    return key != 0 ? key : 1;
+}
+
+QStringList Renderer::blockSource(MD::Item *item, const MdEditor::TextSnapshot &source)
+{
+    QStringList lines;
+    lines.reserve(item->endLine() - item->startLine() + 1);
+    for (qsizetype line = item->startLine(); line <= item->endLine(); ++line) {
+        // Shared with the snapshot
+        lines.append(source.line(line));
+    }
+    return lines;
+}
+
+bool Renderer::CachedBlock::isFrom(MD::Item *item, const MdEditor::TextSnapshot &itemSource) const
+{
+    if (item->type() != type || item->endLine() - item->startLine() + 1 != source.size()) {
+        return false;
+    }
+    if (type == MD::ItemType::Heading && static_cast<MD::Heading *>(item)->label() != label) {
+        return false;
+    }
+
+    for (qsizetype i = 0; i < source.size(); ++i) {
+        if (itemSource.line(item->startLine() + i) != source.at(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Renderer::onBlock(MD::Item *item)
+{
+    if (static_cast<int>(item->type()) >= static_cast<int>(MD::ItemType::UserDefined)) {
+        onUserDefined(item);
+        return;
+    }
+
+    switch (item->type()) {
+    case MD::ItemType::Heading:
+        onHeading(static_cast<MD::Heading *>(item));
+        break;
+    case MD::ItemType::Paragraph:
+        onParagraph(static_cast<MD::Paragraph *>(item), true);
+        break;
+    case MD::ItemType::Code:
+        onCode(static_cast<MD::Code *>(item));
+        break;
+    case MD::ItemType::Blockquote:
+        onBlockquote(static_cast<MD::Blockquote *>(item));
+        break;
+    case MD::ItemType::List:
+        onList(static_cast<MD::List *>(item));
+        break;
+    case MD::ItemType::Table:
+        onTable(static_cast<MD::Table *>(item));
+        break;
+    case MD::ItemType::Anchor:
+        onAnchor(static_cast<MD::Anchor *>(item));
+        break;
+    case MD::ItemType::RawHtml:
+        onRawHtml(static_cast<MD::RawHtml *>(item));
+        break;
+    case MD::ItemType::HorizontalLine:
+        onHorizontalLine(static_cast<MD::HorizontalLine *>(item));
+        break;
+    default:
+        break;
+    }
+}
+
+void Renderer::code(QString &html, QStringView code)
 {
     static const QString buttonStyle = QStringLiteral(
         "class=\"klever-copy-button\" style=\"width:2.2em; height:2.2em; position:absolute; top: 5px; right: 5px; display: flex; justify-content: center; "
@@ -263,20 +589,33 @@ QString Renderer::code(QString &code)
     static const QString svg =
         QStringLiteral("<svg style=\"width: 1.2em; height: 1.2em\" fill=\"currentColor\"> viewBox=\"0 0 16 16\"") + svgPath + QStringLiteral("</svg>");
 
-    static const QString button = QStringLiteral("<button ") + buttonStyle + onClick + svg + QStringLiteral("</button>");
+    // Built once, the code is then copied a single time
+    static const QString opening =
+        QStringLiteral("<pre style=\"position:relative\"><button ") + buttonStyle + onClick + svg + QStringLiteral("</button><code>");
+    static const QString closing = QStringLiteral("</code></pre>\n");
 
-    return QStringLiteral("<pre style=\"position:relative\">") + button + QStringLiteral("<code>") + code + QStringLiteral("</code></pre>\n");
+    // No exact reserve, the reused buffer keeps growing geometrically
+    html.append(opening);
+    html.append(code);
+    html.append(closing);
 }
 
-QString Renderer::openListItem(const bool hasTask, const bool isChecked, const int startNumber)
+void Renderer::openListItem(QString &html, const bool hasTask, const bool isChecked, const int startNumber)
 {
     if (!hasTask) {
-        const QString startNum = 0 <= startNumber ? (QStringLiteral(" value=\"") + QString::number(startNumber) + QStringLiteral("\"")) : QStringLiteral();
-        return QStringLiteral("<li") + startNum + QStringLiteral(">");
+        if (0 <= startNumber) {
+            html.append(QStringLiteral("<li value=\""));
+            html.append(QString::number(startNumber));
+            html.append(QStringLiteral("\">"));
+        } else {
+            html.append(QStringLiteral("<li>"));
+        }
+        return;
     }
 
-    const QString checkboxStr = checkbox(isChecked);
-    return QStringLiteral("<li class=\"hasCheck\"> <label class=\"form-control\">\n") + checkboxStr + QStringLiteral("<span>");
+    html.append(QStringLiteral("<li class=\"hasCheck\"> <label class=\"form-control\">\n"));
+    checkbox(html, isChecked);
+    html.append(QStringLiteral("<span>"));
 }
 
 QString Renderer::closeListItem(const bool hasTask)
@@ -284,11 +623,9 @@ QString Renderer::closeListItem(const bool hasTask)
     return hasTask ? QStringLiteral("</span></label></li>\n") : QStringLiteral("</li>\n");
 }
 
-QString Renderer::checkbox(bool checked)
+void Renderer::checkbox(QString &html, bool checked)
 {
-    const QString checkedString = checked ? QStringLiteral("checked=\"\" ") : QLatin1String();
-
-    return QStringLiteral("<input ") + checkedString + QStringLiteral("disabled=\"\" type=\"checkbox\">");
+    html.append(checked ? QStringLiteral("<input checked=\"\" disabled=\"\" type=\"checkbox\">") : QStringLiteral("<input disabled=\"\" type=\"checkbox\">"));
 }
 
 QString Renderer::wikilink(const QString &href, const QString &title, const QString &text)
@@ -303,56 +640,23 @@ QString Renderer::wikilink(const QString &href, const QString &title, const QStr
     return leading + middle + ending;
 }
 
-QString Renderer::image(const QString &href, const QString &text)
+void Renderer::image(QString &html, const QString &href, const QString &text)
 {
-    return QStringLiteral("<img src=\"") + href + QStringLiteral("\" alt=\"") + text + QStringLiteral("\">");
+    html.append(QStringLiteral("<img src=\""));
+    html.append(href);
+    html.append(QStringLiteral("\" alt=\""));
+    html.append(text);
+    html.append(QStringLiteral("\">"));
 }
 
 QString Renderer::escape(QString &html, bool encode)
 {
-    static const QRegularExpression replace1 = QRegularExpression(QStringLiteral("&(?!#?\\w+;)"));
-    static const QRegularExpression replace2 = QRegularExpression(QStringLiteral("&"));
-
-    const QRegularExpression encodedReplacement = !encode ? replace1 : replace2;
-
-    static const QRegularExpression leftBracketReg = QRegularExpression(QStringLiteral("<"));
-    static const QRegularExpression rightBracketReg = QRegularExpression(QStringLiteral(">"));
-    static const QRegularExpression quoteReg = QRegularExpression(QStringLiteral("\""));
-    static const QRegularExpression apostropheReg = QRegularExpression(QStringLiteral("'"));
-    return html.replace(encodedReplacement, QStringLiteral("&amp;"))
-        .replace(leftBracketReg, QStringLiteral("&lt;"))
-        .replace(rightBracketReg, QStringLiteral("&gt;"))
-        .replace(quoteReg, QStringLiteral("&quot;"))
-        .replace(apostropheReg, QStringLiteral("&#39;"));
+    html = htmlEscape::escape(html, encode);
+    return html;
 }
 
 QString Renderer::unescape(const QString &html)
 {
-    // explicitly match decimal, hex, and named HTML entities
-    QString result = html;
-    static const QRegularExpression regex(QStringLiteral("&(#(?:\\d+)|(?:#x[0-9A-Fa-f]+)|(?:\\w+));?"));
-    QRegularExpressionMatchIterator i = regex.globalMatch(result);
-
-    QRegularExpressionMatch match;
-    while (i.hasNext()) {
-        match = i.next();
-        QString entity = match.captured(1).toLower();
-
-        if (entity == QStringLiteral("colon")) {
-            result.replace(match.capturedStart(), match.capturedLength(), QStringLiteral(":"));
-            continue;
-        }
-        if (entity.startsWith(QStringLiteral("#"))) {
-            bool ok;
-            // check for hexadecimal or numerical value
-            const int charCode = (entity.at(1) == QChar::fromLatin1('x')) ? entity.remove(0, 2).toInt(&ok, 16) : entity.remove(0, 1).toInt(&ok);
-
-            result.replace(match.capturedStart(), match.capturedLength(), QChar(charCode));
-            continue;
-        }
-        result.replace(match.capturedStart(), match.capturedLength(), QLatin1String());
-    }
-
-    return result;
+    return htmlEscape::unescape(html);
 }
 // !Rendering
@@ -7,6 +7,7 @@
 
 #include "plugins/emoji/emojiPlugin.hpp"
 #include "plugins/pluginHelper.h"
+#include "textSnapshot.h"
 #include <utility>
 
 #include <md4qt/src/html.h>
@@ -74,6 +75,53 @@ public:
      */
     void setCodeHighlightEnable(const bool enable);
 
+    /**
+     * @brief Set the parser settings, the cached blocks are only reused with the settings they were parsed with.
+     *
+     * @param quickEmoji Whether the quick emoji are enabled.
+     * @param emojiTone The default tone of the emoji.
+     * @param noteMap Whether the note map is enabled.
+     */
+    void setParserSettings(const bool quickEmoji, const QString &emojiTone, const bool noteMap);
+
+    // Rendering
+    /**
+     * @brief Render the document block by block, the preview only updates the blocks that changed.
+     * Joined, the blocks are the same HTML as `toHtml`.
+     *
+     * @param doc The MD::Document to render.
+     * @param footnoteBackLinkContent The content of the links going back from a footnote to its references.
+     * @return The HTML of each top level item, followed by the footnotes section if any.
+     * Raw HTML left open is joined with the next blocks until it is closed.
+     */
+    QStringList toHtmlBlocks(QSharedPointer<MD::Document> doc, const QString &footnoteBackLinkContent);
+
+    /**
+     * @brief Render the document block by block, reusing the HTML of the blocks whose source did not change since the previous call.
+     * Only the blocks used by this call are kept for the next one.
+     *
+     * @param doc The MD::Document to render.
+     * @param source The text `doc` was parsed from.
+     * @param footnoteBackLinkContent The content of the links going back from a footnote to its references.
+     * @return The HTML of each top level item, followed by the footnotes section if any.
+     * Raw HTML left open is joined with the next blocks until it is closed.
+     */
+    QStringList toHtmlBlocks(QSharedPointer<MD::Document> doc, const MdEditor::TextSnapshot &source, const QString &footnoteBackLinkContent);
+
+    /**
+     * @brief Forget the HTML of the previously rendered blocks.
+     * Needed when something outside of the document changes their rendering.
+     */
+    void clearBlockCache();
+
+    /**
+     * @brief Get the bytes allocated for the HTML by the last call to `toHtmlBlocks`.
+     * Counts the blocks and the growths of the buffer they are rendered in, not the temporaries of md4qt.
+     *
+     * @return The allocated bytes.
+     */
+    qsizetype allocatedBytes() const;
+
     using Base = MD::details::HtmlVisitor;
     // md4qt
     void openStyle(const typename MD::ItemWithOpts::Styles &styles) override;
@@ -97,6 +145,9 @@ public:
     void onLink(MD::Link *l) override;
     using Base::onLink;
 
+    void onFootnoteRef(MD::FootnoteRef *ref) override;
+    using Base::onFootnoteRef;
+
     void onUserDefined(MD::Item *item) override;
     using Base::onUserDefined;
 
@@ -110,22 +161,22 @@ public:
     void onEmoji(EmojiPlugin::EmojiItem *e);
 
     /**
-     * @brief Helper function to `onCode` method, to make custom block of code HTML tags.
+     * @brief Helper function to `onCode` method, to append custom block of code HTML tags.
      *
+     * @param html The HTML to append to.
      * @param code The block of code content.
-     * @return The custom HTML block of code.
      */
-    static QString code(QString &code);
+    static void code(QString &html, QStringView code);
 
     /**
-     * @brief Helper function to `onListItem` to create custom opening HTML tag for list item.
+     * @brief Helper function to `onListItem` to append custom opening HTML tag for list item.
      *
+     * @param html The HTML to append to.
      * @param hasTask Whether the item is a task (checkbox).
      * @param isChecked Whether the checkbox should be checked.
      * @param startNumber Which number should be added if it is an ordered list. -1 will result in an unordered list item.
-     * @return The custom HTML opening tag for a list item.
      */
-    static QString openListItem(const bool hasTask = false, const bool isChecked = false, const int startNumber = -1);
+    static void openListItem(QString &html, const bool hasTask = false, const bool isChecked = false, const int startNumber = -1);
 
     /**
      * @brief Helper function to `onListItem` to create custom closing HTML tag for list item.
@@ -136,12 +187,12 @@ public:
     static QString closeListItem(const bool hasTask = false);
 
     /**
-     * @brief Create a checkbox HTML tag.
+     * @brief Append a checkbox HTML tag.
      *
+     * @param html The HTML to append to.
      * @param checked Whether the checkbox should be checked.
-     * @return A HTML checkbox.
      */
-    static QString checkbox(bool checked);
+    static void checkbox(QString &html, bool checked);
 
     /**
      * @brief Create a wikilink (custom HTML link).
@@ -154,13 +205,13 @@ public:
     static QString wikilink(const QString &href, const QString &title, const QString &text);
 
     /**
-     * @brief Create HTML image.
+     * @brief Append HTML image.
      *
+     * @param html The HTML to append to.
      * @param href The href of the image.
      * @param text The alt text for the image.
-     * @return A HTML image.
      */
-    static QString image(const QString &href, const QString &text);
+    static void image(QString &html, const QString &href, const QString &text);
 
     // TODO: NOT IMPLEMENTED, REMOVE THIS
     static QString text(const QString &text);
@@ -183,15 +234,104 @@ public:
     static QString unescape(const QString &html);
 
 protected:
+    /**
+     * @brief Render a top level item of the document, as `MD::Visitor::process` does.
+     *
+     * @param item The item.
+     */
+    void onBlock(MD::Item *item);
+
+    /**
+     * @brief Render the document block by block, see `toHtmlBlocks`.
+     *
+     * @param doc The MD::Document to render.
+     * @param source The text `doc` was parsed from, nullptr to render every block.
+     * @param footnoteBackLinkContent The content of the links going back from a footnote to its references.
+     * @return The HTML of each top level item, followed by the footnotes section if any.
+     */
+    QStringList renderBlocks(QSharedPointer<MD::Document> doc, const MdEditor::TextSnapshot *source, const QString &footnoteBackLinkContent);
+
+    /**
+     * @brief Take the HTML rendered since the previous block, the buffer is emptied but keeps its capacity.
+     *
+     * @return The HTML of the block.
+     */
+    QString takeBlock();
+
+    /**
+     * @brief Hash what the rendering of every block depends on besides its own source.
+     *
+     * @param doc The MD::Document being rendered.
+     * @return The hash, seed of the block keys.
+     */
+    size_t contextKey(QSharedPointer<MD::Document> doc) const;
+
+    /**
+     * @brief Hash the source of a top level item.
+     *
+     * @param item The top level item.
+     * @param source The text the item was parsed from.
+     * @param context The hash given by `contextKey`.
+     * @return The key of the item in the block cache, 0 if it can't be cached.
+     */
+    static size_t blockKey(MD::Item *item, const MdEditor::TextSnapshot &source, const size_t context);
+
+    /**
+     * @brief Get the lines of a top level item.
+     *
+     * @param item The top level item, cacheable.
+     * @param source The text the item was parsed from.
+     * @return The lines of the item.
+     */
+    static QStringList blockSource(MD::Item *item, const MdEditor::TextSnapshot &source);
+
     QString m_noteDir;
 
     QMap<long long int, std::pair<QString, QString>> m_extendedSyntaxMap;
 
     // Plugins
-    PluginHelper *m_pluginHelper;
+    PluginHelper *m_pluginHelper = nullptr;
 
     bool m_pumlEnable = false;
     bool m_pumlDark = false;
 
     bool m_codeHighlight = false;
+
+    // Hash of the parser settings
+    size_t m_parserSettingsKey = 0;
+
+    // Rendering buffer
+    qsizetype m_htmlCapacity = 0;
+    qsizetype m_allocatedBytes = 0;
+
+    // Block cache
+    /**
+     * @struct CachedBlock
+     * @brief The HTML of a rendered block and the side effects of its rendering.
+     */
+    struct CachedBlock {
+        QString html;
+        // Wikilinks of the block, given again to the note mapper when the block is reused
+        QList<QStringList> linkedNoteInfos;
+        // What the key is made of, compared before reusing the block in case of collision
+        MD::ItemType type;
+        QStringList source;
+        QString label;
+
+        /**
+         * @brief Check if the block was rendered from the given item.
+         *
+         * @param item The top level item.
+         * @param itemSource The text the item was parsed from.
+         * @return True if the item has the same type, source and label, false otherwise.
+         */
+        bool isFrom(MD::Item *item, const MdEditor::TextSnapshot &itemSource) const;
+    };
+    QHash<size_t, CachedBlock> m_blockCache;
+
+    // The top level item being rendered, nullptr outside of `renderBlocks`
+    MD::Item *m_currentBlock = nullptr;
+    // Whether the HTML of the current block only depends on its source
+    bool m_currentBlockCacheable = false;
+    QList<QStringList> m_currentBlockLinkedNoteInfos;
 };
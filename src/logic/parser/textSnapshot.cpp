@@ -0,0 +1,137 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#include "textSnapshot.h"
+
+// C++ include
+#include <algorithm>
+
+// Number of lines held by a new chunk, an edit copies at most a few of them
+static constexpr qsizetype CHUNK_SIZE = 64;
+
+namespace
+{
+void appendChunks(QList<QSharedPointer<const QStringList>> &chunks, const QStringList &lines)
+{
+    for (qsizetype i = 0; i < lines.size(); i += CHUNK_SIZE) {
+        chunks.append(QSharedPointer<const QStringList>::create(lines.mid(i, CHUNK_SIZE)));
+    }
+}
+}
+
+namespace MdEditor
+{
+TextSnapshot TextSnapshot::fromText(const QString &text)
+{
+    TextSnapshot snapshot;
+    appendChunks(snapshot.m_chunks, text.split(QLatin1Char('\n')));
+    snapshot.updateChunkStarts();
+    return snapshot;
+}
+
+TextSnapshot TextSnapshot::replaced(const qsizetype firstLine, const qsizetype removedCount, const QStringList &newLines) const
+{
+    if (m_chunks.isEmpty() || firstLine < 0 || removedCount < 0 || m_lineCount < firstLine + removedCount) {
+        return {};
+    }
+
+    // The chunks touched by the edit are rebuilt, the others are shared
+    qsizetype firstChunk = chunkOf(std::min(firstLine, m_lineCount - 1));
+    qsizetype lastChunk = chunkOf(std::min(firstLine + std::max<qsizetype>(removedCount, 1) - 1, m_lineCount - 1));
+
+    // Small neighbours are merged into the rebuilt chunks, the edits don't leave a trail of tiny chunks
+    if (0 < firstChunk && m_chunks.at(firstChunk - 1)->size() < CHUNK_SIZE / 2) {
+        --firstChunk;
+    }
+    if (lastChunk < m_chunks.size() - 1 && m_chunks.at(lastChunk + 1)->size() < CHUNK_SIZE / 2) {
+        ++lastChunk;
+    }
+
+    QStringList lines;
+    for (qsizetype c = firstChunk; c <= lastChunk; ++c) {
+        lines.append(*m_chunks.at(c));
+    }
+
+    const qsizetype offset = firstLine - m_chunkStarts.at(firstChunk);
+    lines.remove(offset, removedCount);
+    for (qsizetype i = 0; i < newLines.size(); ++i) {
+        lines.insert(offset + i, newLines.at(i));
+    }
+
+    TextSnapshot snapshot;
+    snapshot.m_chunks.reserve(m_chunks.size() + lines.size() / CHUNK_SIZE);
+    snapshot.m_chunks.append(m_chunks.mid(0, firstChunk));
+    appendChunks(snapshot.m_chunks, lines);
+    snapshot.m_chunks.append(m_chunks.mid(lastChunk + 1));
+    snapshot.updateChunkStarts();
+
+    // A note always has a line
+    if (snapshot.m_lineCount == 0) {
+        return fromText({});
+    }
+    return snapshot;
+}
+
+qsizetype TextSnapshot::lineCount() const
+{
+    return m_lineCount;
+}
+
+const QString &TextSnapshot::line(const qsizetype index) const
+{
+    const qsizetype chunk = chunkOf(index);
+    return m_chunks.at(chunk)->at(index - m_chunkStarts.at(chunk));
+}
+
+QString TextSnapshot::text(const qsizetype firstLine, const qsizetype lastLine) const
+{
+    QString result;
+    if (lastLine < firstLine) {
+        return result;
+    }
+
+    qsizetype size = lastLine - firstLine;
+    for (qsizetype i = firstLine; i <= lastLine; ++i) {
+        size += line(i).size();
+    }
+    result.reserve(size);
+
+    for (qsizetype i = firstLine; i <= lastLine; ++i) {
+        result.append(line(i));
+        if (i != lastLine) {
+            result.append(QLatin1Char('\n'));
+        }
+    }
+
+    return result;
+}
+
+QString TextSnapshot::toString() const
+{
+    return text(0, m_lineCount - 1);
+}
+
+qsizetype TextSnapshot::chunkOf(const qsizetype line) const
+{
+    const auto it = std::upper_bound(m_chunkStarts.cbegin(), m_chunkStarts.cend(), line);
+    return std::max<qsizetype>(0, std::distance(m_chunkStarts.cbegin(), it) - 1);
+}
+
+void TextSnapshot::updateChunkStarts()
+{
+    m_chunks.removeIf([](const Chunk &chunk) {
+        return chunk->isEmpty();
+    });
+
+    m_chunkStarts.clear();
+    m_chunkStarts.reserve(m_chunks.size());
+
+    m_lineCount = 0;
+    for (const auto &chunk : std::as_const(m_chunks)) {
+        m_chunkStarts.append(m_lineCount);
+        m_lineCount += chunk->size();
+    }
+}
+}
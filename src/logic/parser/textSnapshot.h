@@ -0,0 +1,102 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+    SPDX-FileCopyrightText: 2026 Louis Schul <schul9louis@gmail.com>
+*/
+
+#pragma once
+
+// Qt include
+#include <QList>
+#include <QMetaType>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+namespace MdEditor
+{
+/**
+ * @class TextSnapshot
+ * @brief Immutable, implicitly shared, view of the lines of a note.
+ *
+ * The lines are stored in small shared chunks. Copying a snapshot only copies the chunk pointers,
+ * and replacing some lines only copies the chunks holding them, the other chunks are shared with the previous snapshots.
+ * This lets the editor hand its text to the parsing thread without copying the whole note on each edit.
+ */
+class TextSnapshot
+{
+public:
+    TextSnapshot() = default;
+
+    /**
+     * @brief Create a snapshot from a whole text.
+     *
+     * @param text The text, its lines are separated by '\n'.
+     * @return The snapshot holding the text.
+     */
+    static TextSnapshot fromText(const QString &text);
+
+    /**
+     * @brief Get a snapshot with the given lines replaced, this snapshot is left untouched.
+     *
+     * @param firstLine The first replaced line.
+     * @param removedCount The number of lines removed, starting at `firstLine`.
+     * @param newLines The lines inserted in place of the removed ones.
+     * @return The edited snapshot.
+     */
+    TextSnapshot replaced(const qsizetype firstLine, const qsizetype removedCount, const QStringList &newLines) const;
+
+    /**
+     * @brief Get the number of lines.
+     *
+     * @return The number of lines, at least 1 for a non null snapshot.
+     */
+    qsizetype lineCount() const;
+
+    /**
+     * @brief Get the given line, without its line break.
+     *
+     * @param index The index of the line.
+     * @return The line.
+     */
+    const QString &line(const qsizetype index) const;
+
+    /**
+     * @brief Join the given lines, separated by '\n'.
+     *
+     * @param firstLine The first line.
+     * @param lastLine The last line.
+     * @return The joined lines.
+     */
+    QString text(const qsizetype firstLine, const qsizetype lastLine) const;
+
+    /**
+     * @brief Join all the lines, separated by '\n'.
+     *
+     * @return The whole text.
+     */
+    QString toString() const;
+
+private:
+    using Chunk = QSharedPointer<const QStringList>;
+
+    /**
+     * @brief Find the chunk holding the given line.
+     *
+     * @param line The line.
+     * @return The index of the chunk.
+     */
+    qsizetype chunkOf(const qsizetype line) const;
+
+    /**
+     * @brief Compute the first line of each chunk.
+     */
+    void updateChunkStarts();
+
+    QList<Chunk> m_chunks;
+    // First line of each chunk
+    QList<qsizetype> m_chunkStarts;
+    qsizetype m_lineCount = 0;
+};
+}
+
+Q_DECLARE_METATYPE(MdEditor::TextSnapshot)
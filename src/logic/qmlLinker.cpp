@@ -3,7 +3,49 @@
 
 #include "qmlLinker.h"
 
+// KleverNotes include
+#include "logic/editor/editorTrace.hpp"
+
+// Qt include
+#include <QSet>
+
 QmlLinker::QmlLinker(QObject *parent)
     : QObject(parent)
 {
 }
+
+bool QmlLinker::tracing() const
+{
+    return editorTrace::isEnabled();
+}
+
+void QmlLinker::textApplied(const double durationMs)
+{
+    editorTrace::previewUpdated(durationMs);
+}
+
+void QmlLinker::setBlocks(const QStringList &ids, const QStringList &blocks)
+{
+    const QSet<QString> previousIds(m_blockIds.cbegin(), m_blockIds.cend());
+
+    QVariantMap newBlocks;
+    for (qsizetype i = 0; i < ids.size(); ++i) {
+        if (!previousIds.contains(ids.at(i))) {
+            newBlocks.insert(ids.at(i), blocks.at(i));
+        }
+    }
+
+    m_blockIds = ids;
+    m_blocks = blocks;
+    Q_EMIT blocksChanged(ids, newBlocks);
+}
+
+QVariantMap QmlLinker::blocksState() const
+{
+    QVariantMap blocks;
+    for (qsizetype i = 0; i < m_blockIds.size(); ++i) {
+        blocks.insert(m_blockIds.at(i), m_blocks.at(i));
+    }
+
+    return {{QStringLiteral("ids"), m_blockIds}, {QStringLiteral("blocks"), blocks}};
+}
@@ -5,6 +5,8 @@
 
 #include <QObject>
 #include <QQmlEngine>
+#include <QStringList>
+#include <QVariantMap>
 
 /**
  * @class QmlLinker
@@ -17,13 +19,54 @@ class QmlLinker : public QObject
     QML_ELEMENT
 
     Q_PROPERTY(QString text MEMBER changedText NOTIFY textChanged FINAL)
+    Q_PROPERTY(bool tracing READ tracing CONSTANT FINAL)
 
 public:
     explicit QmlLinker(QObject *parent = nullptr);
 
+    /**
+     * @brief Check if the editor tracing is enabled, the page only reports its timings when it is.
+     *
+     * @return True if the tracing is enabled, false otherwise.
+     */
+    bool tracing() const;
+
+    /**
+     * @brief Called by the page once it applied the new text.
+     *
+     * @param durationMs The time spent by the page to apply the text, in milliseconds.
+     */
+    Q_INVOKABLE void textApplied(const double durationMs);
+
+    /**
+     * @brief Set the blocks shown by the page, only the blocks it doesn't have yet are sent to it.
+     *
+     * @param ids The id of each block, in the order of the note.
+     * @param blocks The HTML of each block.
+     */
+    Q_INVOKABLE void setBlocks(const QStringList &ids, const QStringList &blocks);
+
+    /**
+     * @brief Get all the blocks, used by the page when it loads or when it lost track of the blocks.
+     *
+     * @return The ordered block ids under "ids" and the HTML of each block, by id, under "blocks".
+     */
+    Q_INVOKABLE QVariantMap blocksState() const;
+
 Q_SIGNALS:
     void textChanged(const QString &text);
 
+    /**
+     * @brief The blocks changed, the page removes the blocks missing from the ids and inserts the new ones.
+     *
+     * @param ids The id of each block, in the order of the note.
+     * @param newBlocks The HTML of the blocks the page doesn't have yet, by id.
+     */
+    void blocksChanged(const QStringList &ids, const QVariantMap &newBlocks);
+
 private:
     QString changedText;
+
+    QStringList m_blockIds;
+    QStringList m_blocks;
 };